@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+
+static inline int64_t bench_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+#else
+#include "esp_timer.h"
+
+static inline int64_t bench_now_us(void)
+{
+    return esp_timer_get_time();
+}
+#endif
+
+/* Data pin used by benchmarks that need an initialized driver (nothing is
+   shown, but the RMT channel still claims the pin) */
+#define BENCH_LED_GPIO 5
+
+/* Keep the optimizer from dropping a benchmarked result */
+static inline void bench_consume(const void *p)
+{
+    __asm__ volatile("" : : "r"(p) : "memory");
+}
+
+/* Individual benchmarks, each prints its own results */
+void bench_transpose(void);
+void bench_span(void);
+void bench_dither(void);
+void bench_chip(void);
+void bench_topology(void);
+void bench_blend(void);
+void bench_math(void);
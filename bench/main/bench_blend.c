@@ -0,0 +1,99 @@
+#include "bench.h"
+#include "led_blend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LEDS 600
+#define LAYERS 3
+#define ROUNDS 200
+
+static const char *const s_mode_names[LED_BLEND_COUNT] = {
+    [LED_BLEND_ADD] = "add",
+    [LED_BLEND_ALPHA] = "alpha",
+    [LED_BLEND_MAX] = "max",
+    [LED_BLEND_MULTIPLY] = "multiply",
+};
+
+void bench_blend(void)
+{
+    const size_t len = LEDS * 3;
+    uint16_t *acc = malloc(len * sizeof(uint16_t));
+    uint16_t *layer16 = malloc(len * sizeof(uint16_t));
+    uint8_t *layer[LAYERS] = {0};
+
+    for (int l = 0; l < LAYERS; l++)
+        layer[l] = malloc(len);
+
+    if (!acc || !layer16 || !layer[0] || !layer[1] || !layer[2])
+    {
+        printf("blend: out of memory\n");
+        goto done;
+    }
+
+    for (size_t i = 0; i < len; i++)
+    {
+        layer[0][i] = (uint8_t)i;
+        layer[1][i] = (uint8_t)(i * 7);
+        layer[2][i] = (uint8_t)(i * 13);
+        layer16[i] = (uint16_t)(i * 7 * 257 + i);
+    }
+
+    /* One layer onto a half-lit accumulator, per mode */
+    for (int m = 0; m < LED_BLEND_COUNT; m++)
+    {
+        for (size_t i = 0; i < len; i++)
+            acc[i] = 0x8000;
+
+        int64_t t0 = bench_now_us();
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            led_blend((led_blend_t)m, acc, layer[1], len, 192);
+            bench_consume(acc);
+        }
+        int64_t t1 = bench_now_us();
+
+        printf("blend %-8s %d LEDs: %lld ns\n", s_mode_names[m], LEDS,
+               (long long)((t1 - t0) * 1000 / ROUNDS));
+    }
+
+    /* Same with a 16-bit layer */
+    for (int m = 0; m < LED_BLEND_COUNT; m++)
+    {
+        for (size_t i = 0; i < len; i++)
+            acc[i] = 0x8000;
+
+        int64_t t0 = bench_now_us();
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            led_blend16((led_blend_t)m, acc, layer16, len, 192);
+            bench_consume(acc);
+        }
+        int64_t t1 = bench_now_us();
+
+        printf("blend16 %-8s %d LEDs: %lld ns\n", s_mode_names[m], LEDS,
+               (long long)((t1 - t0) * 1000 / ROUNDS));
+    }
+
+    /* A 3-layer scene: base alpha, sparkles add, mask multiply */
+    int64_t t0 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        memset(acc, 0, len * sizeof(uint16_t));
+        led_blend_alpha(acc, layer[0], len, 255);
+        led_blend_add(acc, layer[1], len, 128);
+        led_blend_multiply(acc, layer[2], len, 200);
+        bench_consume(acc);
+    }
+    int64_t t1 = bench_now_us();
+
+    printf("blend 3-layer scene %d LEDs: %lld ns per frame\n", LEDS,
+           (long long)((t1 - t0) * 1000 / ROUNDS));
+
+done:
+    for (int l = 0; l < LAYERS; l++)
+        free(layer[l]);
+    free(layer16);
+    free(acc);
+}
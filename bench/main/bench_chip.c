@@ -0,0 +1,61 @@
+#include "bench.h"
+#include "ws2812_chip.h"
+
+#include <stdio.h>
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "ws2812.h"
+#endif
+
+#define ROUNDS 50
+
+static const uint32_t s_sizes[] = {60, 300, 1000};
+
+void bench_chip(void)
+{
+    for (int c = 0; c < WS2812_CHIP_COUNT; c++)
+    {
+        const ws2812_chip_profile_t *p = ws2812_chip_profile((ws2812_chip_t)c);
+
+        for (size_t s = 0; s < sizeof(s_sizes) / sizeof(s_sizes[0]); s++)
+        {
+            uint32_t n = s_sizes[s];
+
+            printf("chip %-12s %4lu LEDs: frame %5lu us, max %4lu fps",
+                   p->name, (unsigned long)n,
+                   (unsigned long)ws2812_chip_frame_us((ws2812_chip_t)c, n),
+                   (unsigned long)ws2812_chip_max_fps((ws2812_chip_t)c, n));
+
+#if !CONFIG_IDF_TARGET_LINUX
+            /* Time show -> done on the real wire. All bits set, so every bit
+               is a long bit, as in the computed worst case. */
+            ws2812_strip_config_t cfg = {
+                .gpio = BENCH_LED_GPIO,
+                .led_count = n,
+                .chip = (ws2812_chip_t)c,
+            };
+            if (ws2812_init_strips(&cfg, 1) != ESP_OK)
+            {
+                printf(", init failed\n");
+                continue;
+            }
+
+            ws2812_set_keepalive_ms(0);
+            ws2812_fill(255, 255, 255);
+            ws2812_show();
+
+            int64_t t0 = bench_now_us();
+            for (int r = 0; r < ROUNDS; r++)
+                ws2812_show();
+            int64_t t1 = bench_now_us();
+
+            ws2812_deinit();
+
+            int64_t frame_us = (t1 - t0) / ROUNDS;
+            printf(", measured %5lld us / %4lld fps",
+                   (long long)frame_us, (long long)(frame_us ? 1000000 / frame_us : 0));
+#endif
+            printf("\n");
+        }
+    }
+}
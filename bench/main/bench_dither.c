@@ -0,0 +1,100 @@
+#include "bench.h"
+#include "ws2812.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LEDS 1000
+#define ROUNDS 200
+
+/* A static 16-bit frame of 8-bit levels has nothing to dither: after the
+   first refresh, show must skip it until the keep-alive */
+static void check_static_skip(void)
+{
+    if (ws2812_init(BENCH_LED_GPIO, 60) != ESP_OK || ws2812_enable_16bit(true) != ESP_OK)
+    {
+        printf("dither: ws2812 init failed\n");
+        ws2812_deinit();
+        return;
+    }
+
+    ws2812_set_keepalive_ms(1000);
+    ws2812_fill(50, 120, 200);
+    ws2812_show();
+
+    uint32_t before = ws2812_get_skipped_frames();
+    ws2812_show();
+    ws2812_show();
+    uint32_t skipped = ws2812_get_skipped_frames() - before;
+
+    printf("dither static 16-bit frame: %lu of 2 repeats skipped%s\n",
+           (unsigned long)skipped, skipped == 2 ? "" : " (FAIL)");
+
+    ws2812_deinit();
+}
+
+void bench_dither(void)
+{
+    const size_t len = LEDS * 3;
+    uint16_t *src = malloc(len * sizeof(uint16_t));
+    uint8_t *dst = malloc(len);
+    uint8_t *err = calloc(1, len);
+    if (!src || !dst || !err)
+    {
+        printf("dither: out of memory\n");
+        goto done;
+    }
+
+    /* A dim fade: values well below one 8-bit step */
+    for (size_t i = 0; i < len; i++)
+        src[i] = (uint16_t)(i % 512);
+
+    int64_t t0 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        ws2812_dither16(dst, src, err, len, NULL, 256);
+        bench_consume(dst);
+    }
+    int64_t t_full = bench_now_us() - t0;
+
+    /* Same with a 2.2 gamma curve applied in 16 bits */
+    static uint16_t gamma[3][WS2812_GAMMA16_POINTS];
+    for (int c = 0; c < 3; c++)
+        ws2812_build_gamma16(gamma[c], 2.2f);
+
+    t0 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        ws2812_dither16(dst, src, err, len, gamma, 256);
+        bench_consume(dst);
+    }
+    int64_t t_gamma = bench_now_us() - t0;
+
+    /* Check the time average of one dim channel over 256 frames */
+    uint32_t sum = 0;
+    uint8_t e = 0;
+    uint16_t v = 100; /* 0.39 of an 8-bit step */
+    for (int f = 0; f < 256; f++)
+    {
+        uint8_t o;
+        ws2812_dither16(&o, &v, &e, 1, NULL, 256);
+        sum += o;
+    }
+
+    long long ns_frame = t_full * 1000 / ROUNDS;
+    long long ns_led_x10 = t_full * 10000 / ROUNDS / LEDS;
+    long long ns_gamma = t_gamma * 1000 / ROUNDS;
+
+    printf("dither %d LEDs: %lld ns/frame, %lld.%lld ns/LED, "
+           "16-bit %u averages %lu/256 over 256 frames\n",
+           LEDS, ns_frame, ns_led_x10 / 10, ns_led_x10 % 10,
+           v, (unsigned long)sum);
+    printf("dither %d LEDs with 16-bit gamma: %lld ns/frame\n", LEDS, ns_gamma);
+
+    check_static_skip();
+
+done:
+    free(src);
+    free(dst);
+    free(err);
+}
@@ -0,0 +1,18 @@
+#include "bench.h"
+
+#include <stdio.h>
+
+void app_main(void)
+{
+    printf("\n=== rgb_bench ===\n");
+
+    bench_transpose();
+    bench_span();
+    bench_dither();
+    bench_chip();
+    bench_topology();
+    bench_blend();
+    bench_math();
+
+    printf("=== done ===\n");
+}
@@ -0,0 +1,145 @@
+#include "bench.h"
+#include "led_effects.h"
+#include "led_math.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define SAMPLES 1024
+#define LEDS 600
+#define ROUNDS 200
+
+void effect_breathe(rgb16_t *buf, uint32_t count, uint32_t offset,
+                    effect_time_t *time, void *user_ctx);
+
+/* Context layout of effect_breathe */
+typedef struct
+{
+    uint16_t phase;
+    uint16_t phase_rem;
+    q8_8_t speed;
+    uint8_t r, g, b;
+} breathe_ctx_t;
+
+typedef struct
+{
+    float phase;
+    float speed;
+    uint8_t r, g, b;
+} breathe_float_ctx_t;
+
+/* effect_breathe as it was before the fixed-point port */
+__attribute__((noinline)) static void breathe_float(rgb_t *buf, uint32_t count, effect_time_t *time,
+                          breathe_float_ctx_t *ctx)
+{
+    ctx->phase += ctx->speed * (time->delta_ms / 1000.0f);
+    if (ctx->phase >= 1.0f)
+        ctx->phase -= 1.0f;
+
+    float level = (ctx->phase < 0.5f) ? (ctx->phase * 2.0f) : ((1.0f - ctx->phase) * 2.0f);
+
+    rgb_t c = {
+        .r = (uint8_t)(ctx->r * level),
+        .g = (uint8_t)(ctx->g * level),
+        .b = (uint8_t)(ctx->b * level)};
+
+    for (uint32_t i = 0; i < count; i++)
+        buf[i] = c;
+}
+
+/* Per-LED color wave, the typical per-pixel use of sin */
+static void wave_float(rgb_t *buf, uint32_t count, uint32_t now_ms)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float s = sinf(i * 0.1f + now_ms * 0.002f);
+        buf[i].r = (uint8_t)(127.5f + 127.5f * s);
+        buf[i].g = (uint8_t)(200.0f * (0.5f + 0.5f * s) * (0.5f + 0.5f * s));
+        buf[i].b = 0;
+    }
+}
+
+static void wave_fixed(rgb_t *buf, uint32_t count, uint32_t now_ms)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t s = sin8((uint8_t)(i * 4 + (now_ms >> 3)));
+        buf[i].r = s;
+        buf[i].g = scale8(ease8_in(s), 200);
+        buf[i].b = 0;
+    }
+}
+
+static rgb_t s_buf[LEDS];
+static rgb16_t s_buf16[LEDS];
+
+void bench_math(void)
+{
+    volatile float fsink = 0;
+    volatile int32_t isink = 0;
+
+    /* Plain sine, one call per sample */
+    int64_t t0 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        float acc = 0;
+        for (int i = 0; i < SAMPLES; i++)
+            acc += sinf((r * SAMPLES + i) * (6.2831853f / 65536.0f));
+        fsink = acc;
+    }
+    int64_t t1 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        int32_t acc = 0;
+        for (int i = 0; i < SAMPLES; i++)
+            acc += sin16((uint16_t)(r * SAMPLES + i));
+        isink = acc;
+    }
+    int64_t t2 = bench_now_us();
+
+    printf("math sinf  %d samples: %lld ns\n", SAMPLES, (long long)((t1 - t0) * 1000 / ROUNDS));
+    printf("math sin16 %d samples: %lld ns\n", SAMPLES, (long long)((t2 - t1) * 1000 / ROUNDS));
+
+    /* Per-pixel wave */
+    t0 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        wave_float(s_buf, LEDS, r * 10);
+        bench_consume(s_buf);
+    }
+    t1 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        wave_fixed(s_buf, LEDS, r * 10);
+        bench_consume(s_buf);
+    }
+    t2 = bench_now_us();
+
+    printf("math wave float %d LEDs: %lld ns\n", LEDS, (long long)((t1 - t0) * 1000 / ROUNDS));
+    printf("math wave fixed %d LEDs: %lld ns\n", LEDS, (long long)((t2 - t1) * 1000 / ROUNDS));
+
+    /* Breathe, float original (8-bit) vs the fixed-point effect (16-bit) */
+    breathe_float_ctx_t fctx = {.speed = 0.5f, .b = 255};
+    breathe_ctx_t ctx = {.speed = Q8_8(0.5f), .b = 255};
+    effect_time_t t = {.delta_ms = 10, .brightness = 255};
+
+    t0 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        breathe_float(s_buf, LEDS, &t, &fctx);
+        bench_consume(s_buf);
+    }
+    t1 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        effect_breathe(s_buf16, LEDS, 0, &t, &ctx);
+        bench_consume(s_buf16);
+    }
+    t2 = bench_now_us();
+
+    printf("math breathe float %d LEDs: %lld ns\n", LEDS, (long long)((t1 - t0) * 1000 / ROUNDS));
+    printf("math breathe fixed %d LEDs: %lld ns\n", LEDS, (long long)((t2 - t1) * 1000 / ROUNDS));
+
+    (void)fsink;
+    (void)isink;
+}
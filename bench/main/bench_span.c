@@ -0,0 +1,89 @@
+#include "bench.h"
+#include "ws2812.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ROUNDS 200
+
+static const uint32_t s_sizes[] = {60, 300, 1000};
+#define MAX_LEDS 1000
+
+void bench_span(void)
+{
+    rgb_t *src = malloc(MAX_LEDS * sizeof(rgb_t));
+    uint8_t *dst = malloc(MAX_LEDS * 3);
+    if (!src || !dst)
+    {
+        printf("span: out of memory\n");
+        goto done;
+    }
+
+    for (uint32_t i = 0; i < MAX_LEDS; i++)
+        src[i] = (rgb_t){.r = (uint8_t)i, .g = (uint8_t)(i * 7), .b = (uint8_t)(i * 13)};
+
+    /* Frame buffer only, nothing is shown */
+    if (ws2812_init(BENCH_LED_GPIO, MAX_LEDS) != ESP_OK)
+    {
+        printf("span: ws2812_init failed\n");
+        goto done;
+    }
+
+    for (size_t s = 0; s < sizeof(s_sizes) / sizeof(s_sizes[0]); s++)
+    {
+        uint32_t n = s_sizes[s];
+
+        int64_t t0 = bench_now_us();
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            ws2812_rgb_to_grb_ref(dst, src, n);
+            bench_consume(dst);
+        }
+        int64_t t1 = bench_now_us();
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            ws2812_rgb_to_grb(dst, src, n);
+            bench_consume(dst);
+        }
+        int64_t t2 = bench_now_us();
+
+        printf("span %4lu LEDs: swizzle ref %lld ns, swar %lld ns",
+               (unsigned long)n,
+               (long long)((t1 - t0) * 1000 / ROUNDS),
+               (long long)((t2 - t1) * 1000 / ROUNDS));
+
+        t0 = bench_now_us();
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            for (uint32_t i = 0; i < n; i++)
+                ws2812_set_pixel(i, src[i].r, src[i].g, src[i].b);
+        }
+        t1 = bench_now_us();
+        for (int r = 0; r < ROUNDS; r++)
+            ws2812_write_span(0, src, n);
+        t2 = bench_now_us();
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            for (uint32_t i = 0; i < n; i++)
+                ws2812_set_pixel(i, 10, 20, 30);
+        }
+        int64_t t3 = bench_now_us();
+        for (int r = 0; r < ROUNDS; r++)
+            ws2812_fill_span(0, n, 10, 20, 30);
+        int64_t t4 = bench_now_us();
+
+        printf(", set_pixel %lld ns, write_span %lld ns, "
+               "set_pixel fill %lld ns, fill_span %lld ns",
+               (long long)((t1 - t0) * 1000 / ROUNDS),
+               (long long)((t2 - t1) * 1000 / ROUNDS),
+               (long long)((t3 - t2) * 1000 / ROUNDS),
+               (long long)((t4 - t3) * 1000 / ROUNDS));
+        printf("\n");
+    }
+
+    ws2812_deinit();
+
+done:
+    free(src);
+    free(dst);
+}
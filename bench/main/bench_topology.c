@@ -0,0 +1,98 @@
+#include "bench.h"
+#include "ws2812.h"
+#include "led_topology.h"
+#include "led_effects.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ROUNDS 200
+
+/* 4-strip bike layout: front and rear wired from the right, the sides
+   daisy-chained so the left one runs backwards */
+static const led_strip_t s_bike[] = {
+    {.led_count = 60, .reversed = false, .gpio = BENCH_LED_GPIO},
+    {.led_count = 144, .reversed = true, .gpio = -1},
+    {.led_count = 144, .reversed = false, .gpio = -1},
+    {.led_count = 60, .reversed = true, .gpio = -1},
+};
+
+static const led_topology_t s_topo = {
+    .strip_count = sizeof(s_bike) / sizeof(s_bike[0]),
+    .strips = s_bike,
+};
+
+/* The strip walk led_topology_map() did before the map table */
+static uint32_t map_walk(uint32_t logical)
+{
+    uint32_t base = 0;
+
+    for (uint8_t i = 0; i < s_topo.strip_count; i++)
+    {
+        const led_strip_t *s = &s_topo.strips[i];
+
+        if (logical < base + s->led_count)
+        {
+            uint32_t local = logical - base;
+            return s->reversed ? base + (s->led_count - 1 - local) : base + local;
+        }
+        base += s->led_count;
+    }
+
+    return base - 1;
+}
+
+void bench_topology(void)
+{
+    if (led_topology_init(&s_topo) != ESP_OK)
+    {
+        printf("topology: init failed\n");
+        return;
+    }
+
+    uint32_t n = led_topology_total_leds();
+    rgb_t *src = malloc(n * sizeof(rgb_t));
+    if (!src)
+    {
+        printf("topology: out of memory\n");
+        return;
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+        src[i] = (rgb_t){.r = (uint8_t)i, .g = (uint8_t)(i * 7), .b = (uint8_t)(i * 13)};
+
+    /* Frame buffer only, nothing is shown */
+    if (ws2812_init(BENCH_LED_GPIO, n) != ESP_OK)
+    {
+        printf("topology: ws2812_init failed\n");
+        goto done;
+    }
+
+    int64_t t0 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        for (uint32_t i = 0; i < n; i++)
+            ws2812_set_pixel(map_walk(i), src[i].r, src[i].g, src[i].b);
+    }
+    int64_t t1 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        for (uint32_t i = 0; i < n; i++)
+            ws2812_set_pixel(led_topology_map(i), src[i].r, src[i].g, src[i].b);
+    }
+    int64_t t2 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+        led_effects_write(0, src, n);
+    int64_t t3 = bench_now_us();
+
+    printf("topology %lu LEDs / %u strips: strip walk %lld ns, map table %lld ns, runs %lld ns\n",
+           (unsigned long)n, (unsigned)s_topo.strip_count,
+           (long long)((t1 - t0) * 1000 / ROUNDS),
+           (long long)((t2 - t1) * 1000 / ROUNDS),
+           (long long)((t3 - t2) * 1000 / ROUNDS));
+
+    ws2812_deinit();
+
+done:
+    free(src);
+}
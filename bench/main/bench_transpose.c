@@ -0,0 +1,93 @@
+#include "bench.h"
+#include "ws2812_transpose.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LANES 16
+#define LEDS_PER_LANE 300
+#define ROUNDS 50
+
+void bench_transpose(void)
+{
+    const size_t lane_bytes = LEDS_PER_LANE * 3;
+    uint8_t *frame = malloc(LANES * lane_bytes);
+    uint8_t *out = malloc(ws2812_transpose_encoded_size(LANES, lane_bytes));
+    if (!frame || !out)
+    {
+        printf("transpose: out of memory\n");
+        goto done;
+    }
+
+    srand(1);
+    for (size_t i = 0; i < LANES * lane_bytes; i++)
+        frame[i] = (uint8_t)rand();
+
+    /* Kernel only: one 16-lane byte slot per call */
+    uint16_t ref[8], swar[8];
+    uint8_t in[LANES];
+    size_t mismatches = 0;
+
+    int64_t t_ref = 0, t_swar = 0;
+
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        int64_t t0 = bench_now_us();
+        for (size_t k = 0; k < lane_bytes; k++)
+        {
+            for (int l = 0; l < LANES; l++)
+                in[l] = frame[l * lane_bytes + k];
+            ws2812_transpose16_ref(in, ref);
+            bench_consume(ref);
+        }
+        int64_t t1 = bench_now_us();
+        for (size_t k = 0; k < lane_bytes; k++)
+        {
+            for (int l = 0; l < LANES; l++)
+                in[l] = frame[l * lane_bytes + k];
+            ws2812_transpose16(in, swar);
+            bench_consume(swar);
+        }
+        int64_t t2 = bench_now_us();
+
+        t_ref += t1 - t0;
+        t_swar += t2 - t1;
+    }
+
+    for (size_t k = 0; k < lane_bytes; k++)
+    {
+        for (int l = 0; l < LANES; l++)
+            in[l] = frame[l * lane_bytes + k];
+        ws2812_transpose16_ref(in, ref);
+        ws2812_transpose16(in, swar);
+        mismatches += memcmp(ref, swar, sizeof(ref)) != 0;
+    }
+
+    /* Full frame encode as the LCD backend runs it */
+    const uint8_t *lanes[LANES];
+    uint32_t lens[LANES];
+    for (int l = 0; l < LANES; l++)
+    {
+        lanes[l] = frame + l * lane_bytes;
+        lens[l] = lane_bytes;
+    }
+
+    int64_t t0 = bench_now_us();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        ws2812_transpose_encode(lanes, lens, LANES, NULL, out);
+        bench_consume(out);
+    }
+    int64_t t_enc = bench_now_us() - t0;
+
+    printf("transpose %dx%d LEDs: ref %lld us/frame, swar %lld us/frame, "
+           "encode %lld us/frame, mismatches %u\n",
+           LANES, LEDS_PER_LANE,
+           (long long)(t_ref / ROUNDS), (long long)(t_swar / ROUNDS),
+           (long long)(t_enc / ROUNDS), (unsigned)mismatches);
+
+done:
+    free(frame);
+    free(out);
+}
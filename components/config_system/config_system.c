@@ -22,6 +22,9 @@ static void set_defaults(system_config_t *cfg)
     cfg->provisioned = false;
     cfg->led_gpio = 5; // default placeholder, user changes later
     cfg->led_count = 60; // default placeholder
+    cfg->power_budget_ma = 0; // unlimited until the supply is known
+    strncpy(cfg->led_chip, "ws2812b", sizeof(cfg->led_chip) - 1);
+    cfg->render_fps = 100;
 
     strncpy(cfg->device_name, "MotoRGB", sizeof(cfg->device_name) - 1);
     strncpy(cfg->ble_name, "MotoRGB", sizeof(cfg->ble_name) - 1);
@@ -58,6 +61,29 @@ static esp_err_t from_json(const char *json, system_config_t *out)
         out->led_count = (uint32_t)j_count->valuedouble;
     }
 
+    cJSON *j_budget = cJSON_GetObjectItemCaseSensitive(root, "power_budget_ma");
+    if (cJSON_IsNumber(j_budget))
+    {
+        out->power_budget_ma = (uint32_t)j_budget->valuedouble;
+    }
+
+    cJSON *j_chip = cJSON_GetObjectItemCaseSensitive(root, "led_chip");
+    if (cJSON_IsString(j_chip) && j_chip->valuestring)
+    {
+        strncpy(out->led_chip, j_chip->valuestring,
+                sizeof(out->led_chip) - 1);
+    }
+
+    // Render task range is 1-1000 FPS; out of range keeps the default
+    cJSON *j_fps = cJSON_GetObjectItemCaseSensitive(root, "render_fps");
+    if (cJSON_IsNumber(j_fps))
+    {
+        if (j_fps->valuedouble >= 1 && j_fps->valuedouble <= 1000)
+            out->render_fps = (uint32_t)j_fps->valuedouble;
+        else
+            ESP_LOGW(TAG, "Ignoring render_fps %.0f (1-1000)", j_fps->valuedouble);
+    }
+
     cJSON *j_devname = cJSON_GetObjectItemCaseSensitive(root, "device_name");
     if (cJSON_IsString(j_devname) && j_devname->valuestring)
     {
@@ -99,6 +125,9 @@ static esp_err_t to_json(const system_config_t *cfg, char **out_json)
     cJSON_AddBoolToObject(root, "provisioned", cfg->provisioned);
     cJSON_AddNumberToObject(root, "led_gpio", cfg->led_gpio);
     cJSON_AddNumberToObject(root, "led_count", (double)cfg->led_count);
+    cJSON_AddNumberToObject(root, "power_budget_ma", (double)cfg->power_budget_ma);
+    cJSON_AddStringToObject(root, "led_chip", cfg->led_chip);
+    cJSON_AddNumberToObject(root, "render_fps", (double)cfg->render_fps);
     cJSON_AddStringToObject(root, "device_name", cfg->device_name);
     cJSON_AddStringToObject(root, "ble_name", cfg->ble_name);
     cJSON_AddStringToObject(root, "ap_password", cfg->ap_password);
@@ -201,6 +230,21 @@ uint32_t system_config_get_led_count(void)
     return g_cfg.led_count;
 }
 
+uint32_t system_config_get_power_budget_ma(void)
+{
+    return g_cfg.power_budget_ma;
+}
+
+const char *system_config_get_led_chip(void)
+{
+    return g_cfg.led_chip;
+}
+
+uint32_t system_config_get_render_fps(void)
+{
+    return g_cfg.render_fps;
+}
+
 const char *system_config_get_ble_name(void)
 {
     return g_cfg.ble_name;
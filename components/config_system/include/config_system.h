@@ -9,6 +9,9 @@ typedef struct
     bool provisioned;   // has first-time setup been completed?
     int led_gpio;       // GPIO pin for WS2812
     uint32_t led_count; // number of LEDs
+    uint32_t power_budget_ma; // LED current cap, 0 = unlimited
+    char led_chip[16];        // LED chip profile ("ws2812b", "sk6812", ...)
+    uint32_t render_fps;      // effect frame rate target
 
     char device_name[32]; // internal name
     char ble_name[32];    // BLE advertised name
@@ -35,5 +38,8 @@ esp_err_t system_config_factory_reset(void);
 bool system_config_is_provisioned(void);
 int system_config_get_led_gpio(void);
 uint32_t system_config_get_led_count(void);
+uint32_t system_config_get_power_budget_ma(void);
+const char *system_config_get_led_chip(void);
+uint32_t system_config_get_render_fps(void);
 const char *system_config_get_ble_name(void);
 const char *system_config_get_device_name(void);
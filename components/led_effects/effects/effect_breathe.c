@@ -1,45 +1,50 @@
 #include "led_effects.h"
-#include "led_topology.h"
-#include "ws2812.h"
+#include "led_math.h"
+
+#include <string.h>
 
 /* Breathing effect state */
 typedef struct
 {
-    float phase;
-    float speed; // cycles per second
+    uint16_t phase;     // fraction of a cycle, 65536 per turn
+    uint16_t phase_rem; // step remainder carried between frames, in 1/1000 phase units
+    q8_8_t speed;       // cycles per second
     uint8_t r, g, b;
 } effect_breathe_ctx_t;
 
+/* 16-bit effect: the level keeps its fraction, so the dim end of the
+   cycle fades smoothly through the output dither */
 void effect_breathe(
-    led_topology_t *unused,
+    rgb16_t *buf,
+    uint32_t count,
+    uint32_t offset,
     effect_time_t *time,
     void *user_ctx)
 {
-    (void)unused;
+    (void)offset;
 
     effect_breathe_ctx_t *ctx = (effect_breathe_ctx_t *)user_ctx;
 
-    /* Advance phase */
-    float delta_sec = time->delta_ms / 1000.0f;
-    ctx->phase += ctx->speed * delta_sec;
-
-    if (ctx->phase >= 1.0f)
-        ctx->phase -= 1.0f;
+    /* Advance phase: speed (Q8.8) * 65536 / 256 per second. The part of a
+       phase unit lost to the division is carried, so the rate does not
+       depend on the frame time. */
+    uint64_t step = (uint64_t)ctx->speed * time->delta_ms * 256 + ctx->phase_rem;
+    ctx->phase += (uint16_t)(step / 1000);
+    ctx->phase_rem = (uint16_t)(step % 1000);
 
     /* Triangle wave */
-    float level = (ctx->phase < 0.5f)
-                      ? (ctx->phase * 2.0f)
-                      : ((1.0f - ctx->phase) * 2.0f);
+    uint16_t level = triangle16(ctx->phase);
 
-    uint8_t r = (uint8_t)(ctx->r * level);
-    uint8_t g = (uint8_t)(ctx->g * level);
-    uint8_t b = (uint8_t)(ctx->b * level);
+    rgb16_t c = {
+        .r = scale16(ctx->r * 257, level),
+        .g = scale16(ctx->g * 257, level),
+        .b = scale16(ctx->b * 257, level)};
 
-    uint16_t total = led_topology_total_leds();
+    if (count == 0)
+        return;
 
-    for (uint16_t logical = 0; logical < total; logical++)
-    {
-        uint16_t physical = led_topology_map(logical);
-        ws2812_set_pixel(physical, r, g, b);
-    }
+    /* Fill by doubling copies: a few memcpy calls instead of a pixel loop */
+    buf[0] = c;
+    for (uint32_t n = 1; n < count; n *= 2)
+        memcpy(buf + n, buf, ((count - n < n) ? count - n : n) * sizeof(rgb16_t));
 }
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Blend kernels for the layer compositor. Each one folds an 8-bit layer
+   (`src`, `len` channel bytes) into a 16-bit accumulator (`acc`, same
+   length) at `opacity` (0-255). Flat, branch-free loops over channel
+   values, so the compiler can vectorize them. The led_blend16 variants
+   take a 16-bit layer (`len` channel values) instead. */
+
+typedef enum
+{
+    LED_BLEND_ADD = 0, // acc + src, saturating
+    LED_BLEND_ALPHA,   // src over acc
+    LED_BLEND_MAX,     // brightest of acc and src
+    LED_BLEND_MULTIPLY, // acc * src (src as a 0-1 mask)
+    LED_BLEND_COUNT,
+} led_blend_t;
+
+void led_blend_add(uint16_t *restrict acc, const uint8_t *restrict src, size_t len, uint8_t opacity);
+void led_blend_alpha(uint16_t *restrict acc, const uint8_t *restrict src, size_t len, uint8_t opacity);
+void led_blend_max(uint16_t *restrict acc, const uint8_t *restrict src, size_t len, uint8_t opacity);
+void led_blend_multiply(uint16_t *restrict acc, const uint8_t *restrict src, size_t len, uint8_t opacity);
+
+void led_blend16_add(uint16_t *restrict acc, const uint16_t *restrict src, size_t len, uint8_t opacity);
+void led_blend16_alpha(uint16_t *restrict acc, const uint16_t *restrict src, size_t len, uint8_t opacity);
+void led_blend16_max(uint16_t *restrict acc, const uint16_t *restrict src, size_t len, uint8_t opacity);
+void led_blend16_multiply(uint16_t *restrict acc, const uint16_t *restrict src, size_t len, uint8_t opacity);
+
+/* Dispatch on `mode` */
+void led_blend(led_blend_t mode, uint16_t *restrict acc, const uint8_t *restrict src,
+               size_t len, uint8_t opacity);
+void led_blend16(led_blend_t mode, uint16_t *restrict acc, const uint16_t *restrict src,
+                 size_t len, uint8_t opacity);
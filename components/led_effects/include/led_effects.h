@@ -2,30 +2,136 @@
 
 #include <stdint.h>
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
 #include "led_topology.h"
+#include "ws2812_color.h"
+#include "led_blend.h"
 
 typedef struct
 {
     uint32_t now_ms;
     uint32_t delta_ms;
-    uint8_t brightness; // 0–255
+    uint8_t brightness; // 0–255, applied by ws2812 at output (do not rescale)
 } effect_time_t;
 
-/* Effect function signature */
+/* Effect function signature: renders `count` pixels into `buf`, which
+   the engine owns; buf[i] is logical LED `offset + i`. The buffer keeps
+   the previous frame, so trails and fades can build on it. Effects never
+   touch the output: the engine maps, blends and writes the buffer. */
 typedef void (*led_effect_fn_t)(
-    led_topology_t *topo,
+    rgb_t *buf,
+    uint32_t count,
+    uint32_t offset,
     effect_time_t *time,
     void *user_ctx);
 
-/* Effect descriptor */
+/* Same with 16-bit linear pixels (0-65535), for effects that need levels
+   between the 8-bit steps (slow or dim fades). Written out through the
+   16-bit path, so with ws2812_enable_16bit() the fraction survives to the
+   dither. */
+typedef void (*led_effect16_fn_t)(
+    rgb16_t *buf,
+    uint32_t count,
+    uint32_t offset,
+    effect_time_t *time,
+    void *user_ctx);
+
+/* Effect descriptor: set `render` or `render16` (used if both are set) */
 typedef struct
 {
     const char *name;
     led_effect_fn_t render;
+    led_effect16_fn_t render16;
     void *user_ctx;
 } led_effect_t;
 
-/* Engine control */
+/* Transition easing */
+typedef enum
+{
+    LED_CURVE_LINEAR = 0,
+    LED_CURVE_EASE_IN,     // quadratic, slow start
+    LED_CURVE_EASE_OUT,    // quadratic, slow end
+    LED_CURVE_EASE_IN_OUT, // smoothstep
+} led_curve_t;
+
+#define LED_EFFECTS_MAX_LAYERS 4
+
+/* One layer of the stack */
+typedef struct
+{
+    const char *name;
+    led_effect_fn_t render;
+    led_effect16_fn_t render16; // 16-bit layer, used instead of render
+    void *user_ctx;
+    led_blend_t blend; // how it combines with the layers below
+    uint8_t opacity;   // 0-255
+    const char *zone;  // topology zone it covers, NULL = every LED
+} led_layer_t;
+
+/* Engine control. led_effects_set() runs a single effect,
+   led_effects_set_layers() a stack of up to LED_EFFECTS_MAX_LAYERS layers
+   (bottom first) composited over black in 16 bits; each replaces the
+   other. The layer array is copied. A layer bound to a zone renders
+   only the zone's range (offset = zone start) and leaves the LEDs
+   outside it to the layers below. */
 esp_err_t led_effects_init(led_topology_t *topology);
 esp_err_t led_effects_set(const led_effect_t *effect);
+esp_err_t led_effects_set_layers(const led_layer_t *layers, size_t count);
 void led_effects_tick(uint32_t now_ms);
+
+/* Crossfade to `effect` over `duration_ms`. Both effects render every
+   frame into buffers from a pool allocated at init (sized for 16-bit
+   pixels, so either kind fits), so switching never allocates. The fade
+   starts from black when a layer stack was running; a new transition
+   during one continues from the effect being faded in. */
+esp_err_t led_effects_transition_to(const led_effect_t *effect, uint32_t duration_ms,
+                                    led_curve_t curve);
+
+/* Render task: renders and shows one frame per period of a drift-free
+   frame clock, independent of render and wire time */
+typedef struct
+{
+    uint32_t fps;        // target frame rate, 1-1000
+    int core;            // core the task is pinned to
+    uint32_t stack_size; // bytes
+    UBaseType_t priority;
+} led_effects_task_config_t;
+
+#define LED_EFFECTS_TASK_CONFIG_DEFAULT() { \
+    .fps = 100,                             \
+    .core = 1,                              \
+    .stack_size = 4096,                     \
+    .priority = 5,                          \
+}
+
+/* Frame pacing of the render task */
+typedef struct
+{
+    uint32_t frames;           // frames rendered since start / FPS change
+    uint32_t dropped;          // frames skipped because rendering fell behind
+    uint32_t target_period_us;
+    uint32_t period_avg_us;    // measured period, dropped frames included
+    uint32_t jitter_avg_us;    // |start - scheduled start|, averaged; the
+                               // schedule is first start + k * period
+    uint32_t jitter_max_us;
+    uint32_t render_avg_us;    // effect tick + queueing the frame
+    uint32_t render_max_us;
+} led_effects_timing_t;
+
+/* Start / stop the render task. While it runs, do not call
+   led_effects_tick() yourself. Target only: the linux host build has no
+   render task (no esp_timer) and calls led_effects_tick() directly. */
+esp_err_t led_effects_start(const led_effects_task_config_t *cfg);
+void led_effects_stop(void);
+
+/* Change the target frame rate of the running task (resets timing) */
+esp_err_t led_effects_set_fps(uint32_t fps);
+
+/* Snapshot of the pacing statistics; ESP_ERR_INVALID_STATE when stopped */
+esp_err_t led_effects_get_timing(led_effects_timing_t *out);
+
+/* Write `count` pixels in logical order starting at `logical_start` to the
+   frame buffer. Works per topology run: forward runs are one span copy,
+   reversed runs one reverse copy, with no per-LED mapping. */
+void led_effects_write(uint32_t logical_start, const rgb_t *src, uint32_t count);
+void led_effects_write16(uint32_t logical_start, const rgb16_t *src, uint32_t count);
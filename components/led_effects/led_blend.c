@@ -0,0 +1,154 @@
+#include "led_blend.h"
+
+/* Opacity 0-255 as a Q8 factor 0-256, so 255 is exactly 1.0 */
+static inline uint32_t opacity_q8(uint8_t opacity)
+{
+    return opacity + (opacity >> 7);
+}
+
+/* 8-bit source value widened to 16 bits and scaled by k (Q8):
+   v * 257 * k / 256 */
+static inline uint32_t widen(uint8_t v, uint32_t k)
+{
+    return (v * 257u * k) >> 8;
+}
+
+void led_blend_add(uint16_t *restrict acc, const uint8_t *restrict src, size_t len, uint8_t opacity)
+{
+    const uint32_t k = opacity_q8(opacity);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        uint32_t v = acc[i] + widen(src[i], k);
+        acc[i] = (uint16_t)(v > 0xFFFF ? 0xFFFF : v);
+    }
+}
+
+void led_blend_alpha(uint16_t *restrict acc, const uint8_t *restrict src, size_t len, uint8_t opacity)
+{
+    const int32_t k = opacity_q8(opacity);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        int32_t a = acc[i];
+        int32_t v = src[i] * 257;
+        acc[i] = (uint16_t)(a + (((v - a) * k) >> 8));
+    }
+}
+
+void led_blend_max(uint16_t *restrict acc, const uint8_t *restrict src, size_t len, uint8_t opacity)
+{
+    const uint32_t k = opacity_q8(opacity);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        uint32_t v = widen(src[i], k);
+        acc[i] = (uint16_t)(v > acc[i] ? v : acc[i]);
+    }
+}
+
+void led_blend_multiply(uint16_t *restrict acc, const uint8_t *restrict src, size_t len, uint8_t opacity)
+{
+    const int32_t k = opacity_q8(opacity);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        int32_t a = acc[i];
+        /* a * src / 255, within 1 LSB (the product needs all 32 bits) */
+        int32_t m = (int32_t)((acc[i] * (src[i] * 257u)) >> 16);
+        acc[i] = (uint16_t)(a + (((m - a) * k) >> 8));
+    }
+}
+
+void led_blend(led_blend_t mode, uint16_t *restrict acc, const uint8_t *restrict src,
+               size_t len, uint8_t opacity)
+{
+    switch (mode)
+    {
+    case LED_BLEND_ADD:
+        led_blend_add(acc, src, len, opacity);
+        break;
+    case LED_BLEND_ALPHA:
+        led_blend_alpha(acc, src, len, opacity);
+        break;
+    case LED_BLEND_MAX:
+        led_blend_max(acc, src, len, opacity);
+        break;
+    case LED_BLEND_MULTIPLY:
+        led_blend_multiply(acc, src, len, opacity);
+        break;
+    default:
+        break;
+    }
+}
+
+/* ---------------- 16-bit layers ---------------- */
+
+void led_blend16_add(uint16_t *restrict acc, const uint16_t *restrict src, size_t len, uint8_t opacity)
+{
+    const uint32_t k = opacity_q8(opacity);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        uint32_t v = acc[i] + ((src[i] * k) >> 8);
+        acc[i] = (uint16_t)(v > 0xFFFF ? 0xFFFF : v);
+    }
+}
+
+void led_blend16_alpha(uint16_t *restrict acc, const uint16_t *restrict src, size_t len, uint8_t opacity)
+{
+    const int32_t k = opacity_q8(opacity);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        int32_t a = acc[i];
+        int32_t v = src[i];
+        acc[i] = (uint16_t)(a + (((v - a) * k) >> 8));
+    }
+}
+
+void led_blend16_max(uint16_t *restrict acc, const uint16_t *restrict src, size_t len, uint8_t opacity)
+{
+    const uint32_t k = opacity_q8(opacity);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        uint32_t v = (src[i] * k) >> 8;
+        acc[i] = (uint16_t)(v > acc[i] ? v : acc[i]);
+    }
+}
+
+void led_blend16_multiply(uint16_t *restrict acc, const uint16_t *restrict src, size_t len, uint8_t opacity)
+{
+    const int32_t k = opacity_q8(opacity);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        int32_t a = acc[i];
+        /* a * src / 65535, within 1 LSB */
+        int32_t m = (int32_t)(((uint32_t)acc[i] * src[i]) >> 16);
+        acc[i] = (uint16_t)(a + (((m - a) * k) >> 8));
+    }
+}
+
+void led_blend16(led_blend_t mode, uint16_t *restrict acc, const uint16_t *restrict src,
+                 size_t len, uint8_t opacity)
+{
+    switch (mode)
+    {
+    case LED_BLEND_ADD:
+        led_blend16_add(acc, src, len, opacity);
+        break;
+    case LED_BLEND_ALPHA:
+        led_blend16_alpha(acc, src, len, opacity);
+        break;
+    case LED_BLEND_MAX:
+        led_blend16_max(acc, src, len, opacity);
+        break;
+    case LED_BLEND_MULTIPLY:
+        led_blend16_multiply(acc, src, len, opacity);
+        break;
+    default:
+        break;
+    }
+}
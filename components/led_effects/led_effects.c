@@ -1,38 +1,426 @@
 #include "led_effects.h"
+#include "led_math.h"
+#include "ws2812.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/semphr.h"
 
 static led_topology_t *s_topo = NULL;
 static const led_effect_t *s_current = NULL;
 
 static uint32_t s_last_ms = 0;
 
+/* Held while a frame renders, so the effect or layer stack can be
+   swapped from another task than the render task */
+static SemaphoreHandle_t s_lock = NULL;
+
+/* Frame pool, allocated at init for the topology size: the running
+   effect renders into s_pool[s_pool_cur], the effect being faded out
+   into the other one. Each buffer holds n rgb16_t, so 8-bit and 16-bit
+   effects both fit. s_acc is the 16-bit blend accumulator. */
+static void *s_pool[2] = {NULL, NULL};
+static uint8_t s_pool_cur = 0;
+static rgb16_t *s_acc = NULL;
+static uint32_t s_pool_leds = 0;
+
+/* Transition from s_from (NULL = black) to s_current */
+static bool s_fading = false;
+static bool s_fade_pending = true; // start time taken on the next tick
+static const led_effect_t *s_from = NULL;
+static uint32_t s_fade_start_ms = 0;
+static uint32_t s_fade_ms = 0;
+static led_curve_t s_fade_curve = LED_CURVE_LINEAR;
+
+/* Layer stack: each layer keeps its own pixel buffer between frames
+   (logical order), composited into the accumulator every tick over the
+   logical range it covers */
+static led_layer_t s_layers[LED_EFFECTS_MAX_LAYERS];
+static size_t s_layer_count = 0;
+static void *s_layer_buf[LED_EFFECTS_MAX_LAYERS]; // rgb16_t for 16-bit layers
+static uint32_t s_layer_start[LED_EFFECTS_MAX_LAYERS];
+static uint32_t s_layer_len[LED_EFFECTS_MAX_LAYERS];
+static uint32_t s_layer_leds = 0;
+
+static void pool_free(void)
+{
+    free(s_pool[0]);
+    free(s_pool[1]);
+    free(s_acc);
+    s_pool[0] = s_pool[1] = NULL;
+    s_acc = NULL;
+    s_pool_leds = 0;
+}
+
 esp_err_t led_effects_init(led_topology_t *topology)
 {
     if (!topology)
         return ESP_ERR_INVALID_ARG;
+
+    if (!s_lock)
+    {
+        s_lock = xSemaphoreCreateMutex();
+        if (!s_lock)
+            return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t n = led_topology_total_leds();
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    if (s_pool_leds != n)
+    {
+        pool_free();
+        s_pool[0] = calloc(n, sizeof(rgb16_t));
+        s_pool[1] = calloc(n, sizeof(rgb16_t));
+        s_acc = malloc(n * sizeof(rgb16_t));
+
+        if (!s_pool[0] || !s_pool[1] || !s_acc)
+        {
+            pool_free();
+            xSemaphoreGive(s_lock);
+            return ESP_ERR_NO_MEM;
+        }
+        s_pool_leds = n;
+    }
+
     s_topo = topology;
     s_last_ms = 0;
+    s_current = NULL;
+    s_fading = false;
+    s_layer_count = 0;
+
+    xSemaphoreGive(s_lock);
     return ESP_OK;
 }
 
+static inline bool effect_valid(const led_effect_t *effect)
+{
+    return effect && (effect->render || effect->render16);
+}
+
 esp_err_t led_effects_set(const led_effect_t *effect)
 {
-    if (!effect || !effect->render)
+    if (!effect_valid(effect))
         return ESP_ERR_INVALID_ARG;
+    if (!s_lock)
+        return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    /* The new effect starts on a black buffer: the old frame may not even
+       be the same pixel width */
+    if (s_pool_leds)
+        memset(s_pool[s_pool_cur], 0, s_pool_leds * sizeof(rgb16_t));
+
     s_current = effect;
+    s_fading = false;
+    s_from = NULL;
+    s_layer_count = 0;
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+esp_err_t led_effects_transition_to(const led_effect_t *effect, uint32_t duration_ms,
+                                    led_curve_t curve)
+{
+    if (!effect_valid(effect))
+        return ESP_ERR_INVALID_ARG;
+    if (!s_lock || !s_pool_leds)
+        return ESP_ERR_INVALID_STATE;
+    if (duration_ms == 0)
+        return led_effects_set(effect);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    /* The outgoing effect keeps its buffer (and with it any trail state);
+       the incoming one starts on the other, cleared */
+    s_from = (s_layer_count == 0) ? s_current : NULL;
+    s_pool_cur ^= 1;
+    memset(s_pool[s_pool_cur], 0, s_pool_leds * sizeof(rgb16_t));
+    if (!s_from)
+        memset(s_pool[s_pool_cur ^ 1], 0, s_pool_leds * sizeof(rgb16_t));
+
+    s_current = effect;
+    s_layer_count = 0;
+    s_fade_ms = duration_ms;
+    s_fade_curve = curve;
+    s_fade_pending = true;
+    s_fading = true;
+
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+static void layer_bufs_free(void **bufs)
+{
+    for (size_t i = 0; i < LED_EFFECTS_MAX_LAYERS; i++)
+        free(bufs[i]);
+}
+
+esp_err_t led_effects_set_layers(const led_layer_t *layers, size_t count)
+{
+    if (!layers || count == 0 || count > LED_EFFECTS_MAX_LAYERS)
+        return ESP_ERR_INVALID_ARG;
+    if (!s_lock)
+        return ESP_ERR_INVALID_STATE;
+
+    uint32_t n = led_topology_total_leds();
+    uint32_t start[LED_EFFECTS_MAX_LAYERS];
+    uint32_t len[LED_EFFECTS_MAX_LAYERS];
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if ((!layers[i].render && !layers[i].render16) || layers[i].blend >= LED_BLEND_COUNT)
+            return ESP_ERR_INVALID_ARG;
+
+        start[i] = 0;
+        len[i] = n;
+
+        if (layers[i].zone)
+        {
+            const led_zone_t *z = led_topology_zone(layers[i].zone);
+            if (!z)
+                return ESP_ERR_NOT_FOUND;
+            start[i] = z->start;
+            len[i] = z->count;
+        }
+    }
+
+    /* New layers start black. Their buffers are allocated before taking
+       the lock and swapped in under it, so the render task never waits on
+       the heap and a failed allocation leaves the running stack alone. */
+    void *bufs[LED_EFFECTS_MAX_LAYERS] = {NULL};
+
+    for (size_t i = 0; i < count; i++)
+    {
+        bufs[i] = calloc(n, layers[i].render16 ? sizeof(rgb16_t) : sizeof(rgb_t));
+        if (!bufs[i])
+        {
+            layer_bufs_free(bufs);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    if (!s_acc)
+    {
+        xSemaphoreGive(s_lock);
+        layer_bufs_free(bufs);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Swap: the old buffers come back in `bufs` and are freed unlocked */
+    for (size_t i = 0; i < LED_EFFECTS_MAX_LAYERS; i++)
+    {
+        void *old = s_layer_buf[i];
+        s_layer_buf[i] = bufs[i];
+        bufs[i] = old;
+    }
+
+    s_layer_leds = n;
+    memcpy(s_layers, layers, count * sizeof(layers[0]));
+    memcpy(s_layer_start, start, count * sizeof(start[0]));
+    memcpy(s_layer_len, len, count * sizeof(len[0]));
+    s_layer_count = count;
+    s_current = NULL;
+    s_fading = false;
+
+    xSemaphoreGive(s_lock);
+
+    layer_bufs_free(bufs);
     return ESP_OK;
 }
 
+/* Write a logically ordered range through the topology runs: one span
+   write per run, reversed runs with the reverse writer */
+static void write_runs(uint32_t logical_start, uint32_t count, const void *src, bool wide)
+{
+    uint32_t end = logical_start + count;
+    led_run_iter_t it;
+    led_run_t run;
+
+    led_topology_runs_begin(&it);
+    while (led_topology_runs_next(&it, &run))
+    {
+        uint32_t run_end = run.logical_start + run.length;
+
+        if (run_end <= logical_start)
+            continue;
+        if (run.logical_start >= end)
+            break;
+
+        uint32_t from = (logical_start > run.logical_start) ? logical_start : run.logical_start;
+        uint32_t to = (end < run_end) ? end : run_end;
+        uint32_t n = to - from;
+        uint32_t skip = from - run.logical_start;
+        uint32_t offset = from - logical_start;
+
+        if (run.stride > 0)
+        {
+            uint32_t phys = run.physical_start + skip;
+            if (wide)
+                ws2812_write_span16(phys, (const rgb16_t *)src + offset, n);
+            else
+                ws2812_write_span(phys, (const rgb_t *)src + offset, n);
+        }
+        else
+        {
+            uint32_t phys = run.physical_start - skip - (n - 1);
+            if (wide)
+                ws2812_write_span16_reverse(phys, (const rgb16_t *)src + offset, n);
+            else
+                ws2812_write_span_reverse(phys, (const rgb_t *)src + offset, n);
+        }
+    }
+}
+
+void led_effects_write(uint32_t logical_start, const rgb_t *src, uint32_t count)
+{
+    write_runs(logical_start, count, src, false);
+}
+
+void led_effects_write16(uint32_t logical_start, const rgb16_t *src, uint32_t count)
+{
+    write_runs(logical_start, count, src, true);
+}
+
+/* Transition progress (0-65535) through the easing curve */
+static uint16_t curve_apply(led_curve_t curve, uint16_t x)
+{
+    switch (curve)
+    {
+    case LED_CURVE_EASE_IN:
+        return ease16_in(x);
+    case LED_CURVE_EASE_OUT:
+        return ease16_out(x);
+    case LED_CURVE_EASE_IN_OUT:
+        return ease16_in_out(x);
+    default:
+        return x;
+    }
+}
+
+/* Render `count` pixels into `buf` at the width the effect asks for;
+   returns true for 16-bit pixels */
+static bool render_effect(led_effect_fn_t render, led_effect16_fn_t render16, void *user_ctx,
+                          void *buf, uint32_t count, uint32_t offset, effect_time_t *t)
+{
+    if (render16)
+    {
+        render16((rgb16_t *)buf, count, offset, t, user_ctx);
+        return true;
+    }
+
+    render((rgb_t *)buf, count, offset, t, user_ctx);
+    return false;
+}
+
+/* Fold `count` pixels of either width into the accumulator */
+static void blend_pixels(led_blend_t mode, uint16_t *acc, const void *buf, uint32_t count,
+                         uint8_t opacity, bool wide)
+{
+    if (wide)
+        led_blend16(mode, acc, (const uint16_t *)buf, count * 3, opacity);
+    else
+        led_blend(mode, acc, (const uint8_t *)buf, count * 3, opacity);
+}
+
+static void render_current(effect_time_t *t)
+{
+    void *buf = s_pool[s_pool_cur];
+
+    if (render_effect(s_current->render, s_current->render16, s_current->user_ctx,
+                      buf, s_pool_leds, 0, t))
+        led_effects_write16(0, buf, s_pool_leds);
+    else
+        led_effects_write(0, buf, s_pool_leds);
+}
+
+/* Both effects render into their pool buffers and are mixed in 16 bits */
+static void render_transition(effect_time_t *t)
+{
+    if (s_fade_pending)
+    {
+        s_fade_start_ms = t->now_ms;
+        s_fade_pending = false;
+    }
+
+    uint32_t elapsed = t->now_ms - s_fade_start_ms;
+    if (elapsed >= s_fade_ms)
+    {
+        s_fading = false;
+        s_from = NULL;
+        render_current(t);
+        return;
+    }
+
+    uint32_t n = s_pool_leds;
+    void *from = s_pool[s_pool_cur ^ 1];
+    void *to = s_pool[s_pool_cur];
+    uint16_t *acc = (uint16_t *)s_acc;
+
+    /* Without an outgoing effect `from` stays black */
+    bool from_wide = s_from && render_effect(s_from->render, s_from->render16,
+                                             s_from->user_ctx, from, n, 0, t);
+    bool to_wide = render_effect(s_current->render, s_current->render16,
+                                 s_current->user_ctx, to, n, 0, t);
+
+    uint16_t x = curve_apply(s_fade_curve, (uint16_t)(((uint64_t)elapsed * 65535) / s_fade_ms));
+
+    memset(s_acc, 0, n * sizeof(rgb16_t));
+    blend_pixels(LED_BLEND_ALPHA, acc, from, n, 255, from_wide);
+    blend_pixels(LED_BLEND_ALPHA, acc, to, n, (uint8_t)(x >> 8), to_wide);
+
+    led_effects_write16(0, s_acc, n);
+}
+
+/* Render every layer into its buffer and fold its range into the
+   accumulator, bottom layer first, then send the result out */
+static void render_layers(effect_time_t *t)
+{
+    uint32_t n = s_layer_leds;
+    uint16_t *acc = (uint16_t *)s_acc;
+
+    memset(s_acc, 0, n * sizeof(rgb16_t));
+
+    for (size_t i = 0; i < s_layer_count; i++)
+    {
+        const led_layer_t *l = &s_layers[i];
+        uint32_t start = s_layer_start[i];
+        uint32_t len = s_layer_len[i];
+        void *buf = l->render16 ? (void *)((rgb16_t *)s_layer_buf[i] + start)
+                                : (void *)((rgb_t *)s_layer_buf[i] + start);
+
+        bool wide = render_effect(l->render, l->render16, l->user_ctx, buf, len, start, t);
+        blend_pixels(l->blend, acc + start * 3, buf, len, l->opacity, wide);
+    }
+
+    led_effects_write16(0, s_acc, n);
+}
+
 void led_effects_tick(uint32_t now_ms)
 {
-    if (!s_topo || !s_current)
+    if (!s_topo || !s_lock)
         return;
 
     effect_time_t t = {
         .now_ms = now_ms,
         .delta_ms = (s_last_ms == 0) ? 0 : (now_ms - s_last_ms),
-        .brightness = 255};
+        .brightness = ws2812_get_brightness()};
 
     s_last_ms = now_ms;
 
-    s_current->render(s_topo, &t, s_current->user_ctx);
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    if (s_layer_count)
+        render_layers(&t);
+    else if (s_fading)
+        render_transition(&t);
+    else if (s_current)
+        render_current(&t);
+
+    xSemaphoreGive(s_lock);
 }
@@ -0,0 +1,200 @@
+#include "led_effects.h"
+#include "ws2812.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "led_effects";
+
+/* Frame clock: a periodic esp_timer notifies the render task. The timer
+   period is exact in microseconds and does not drift, unlike a tick-based
+   delay (10 ms ticks at CONFIG_FREERTOS_HZ=100). */
+static esp_timer_handle_t s_clock = NULL;
+static TaskHandle_t s_task = NULL;
+static SemaphoreHandle_t s_stopped = NULL;
+static volatile bool s_running = false;
+static uint32_t s_period_us = 0;
+
+/* Timing, owned by the render task; readers take s_timing_lock */
+static portMUX_TYPE s_timing_lock = portMUX_INITIALIZER_UNLOCKED;
+static led_effects_timing_t s_timing;
+static uint64_t s_jitter_sum_us = 0;
+static uint64_t s_render_sum_us = 0;
+static int64_t s_first_start_us = 0;
+static uint32_t s_periods = 0; // frame clock periods since the first start
+
+static void frame_clock_cb(void *arg)
+{
+    xTaskNotifyGive(s_task);
+}
+
+static void timing_reset(void)
+{
+    taskENTER_CRITICAL(&s_timing_lock);
+    memset(&s_timing, 0, sizeof(s_timing));
+    s_jitter_sum_us = 0;
+    s_render_sum_us = 0;
+    s_first_start_us = 0;
+    s_periods = 0;
+    taskEXIT_CRITICAL(&s_timing_lock);
+}
+
+static void timing_record(int64_t start_us, int64_t end_us, uint32_t missed)
+{
+    uint32_t render_us = (uint32_t)(end_us - start_us);
+
+    taskENTER_CRITICAL(&s_timing_lock);
+
+    s_timing.frames++;
+    s_timing.dropped += missed;
+    s_render_sum_us += render_us;
+    if (render_us > s_timing.render_max_us)
+        s_timing.render_max_us = render_us;
+
+    /* Jitter: how far each frame start is from its slot on the frame
+       clock, i.e. the first start plus a whole number of periods (dropped
+       frames included). Measured against that fixed schedule, drift
+       shows up and one late frame counts once. */
+    if (s_first_start_us)
+    {
+        s_periods += missed + 1;
+
+        int64_t scheduled = s_first_start_us + (int64_t)s_periods * s_period_us;
+        int64_t offset = start_us - scheduled;
+        uint32_t jitter = (uint32_t)(offset < 0 ? -offset : offset);
+
+        s_jitter_sum_us += jitter;
+        if (jitter > s_timing.jitter_max_us)
+            s_timing.jitter_max_us = jitter;
+
+        s_timing.period_avg_us = (uint32_t)((start_us - s_first_start_us) / s_periods);
+        s_timing.jitter_avg_us = s_jitter_sum_us / (s_timing.frames - 1);
+    }
+    else
+    {
+        s_first_start_us = start_us;
+    }
+    s_timing.render_avg_us = s_render_sum_us / s_timing.frames;
+
+    taskEXIT_CRITICAL(&s_timing_lock);
+}
+
+static void render_task(void *arg)
+{
+    while (true)
+    {
+        /* Every pending tick is taken at once: when a frame overran, the
+           missed frames are dropped rather than rendered back to back,
+           and effect time (now_ms) jumps ahead to catch up */
+        uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!s_running)
+            break;
+
+        int64_t start_us = esp_timer_get_time();
+
+        led_effects_tick((uint32_t)(start_us / 1000));
+
+        /* Queues the frame and returns; only waits if the previous one
+           is still on the wire */
+        ws2812_show_async();
+
+        timing_record(start_us, esp_timer_get_time(), ticks - 1);
+    }
+
+    xSemaphoreGive(s_stopped);
+    vTaskDelete(NULL);
+}
+
+esp_err_t led_effects_start(const led_effects_task_config_t *cfg)
+{
+    ESP_RETURN_ON_FALSE(cfg && cfg->fps > 0 && cfg->fps <= 1000, ESP_ERR_INVALID_ARG,
+                        TAG, "Invalid render config");
+    ESP_RETURN_ON_FALSE(!s_running, ESP_ERR_INVALID_STATE, TAG, "Render task already running");
+
+    esp_err_t ret = ESP_OK;
+
+    s_stopped = xSemaphoreCreateBinary();
+    ESP_RETURN_ON_FALSE(s_stopped, ESP_ERR_NO_MEM, TAG, "No memory for semaphore");
+
+    const esp_timer_create_args_t clock_args = {
+        .callback = frame_clock_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "led_frame",
+        .skip_unhandled_events = true,
+    };
+    ESP_GOTO_ON_ERROR(esp_timer_create(&clock_args, &s_clock), err, TAG, "Cannot create frame clock");
+
+    timing_reset();
+    s_period_us = 1000000 / cfg->fps;
+    s_running = true;
+
+    ESP_GOTO_ON_FALSE(xTaskCreatePinnedToCore(render_task, "led_render", cfg->stack_size, NULL,
+                                              cfg->priority, &s_task, cfg->core) == pdPASS,
+                      ESP_ERR_NO_MEM, err, TAG, "Cannot create render task");
+
+    ESP_GOTO_ON_ERROR(esp_timer_start_periodic(s_clock, s_period_us), err, TAG, "Cannot start frame clock");
+
+    ESP_LOGI(TAG, "Render task on core %d at %lu FPS", cfg->core, (unsigned long)cfg->fps);
+    return ESP_OK;
+
+err:
+    led_effects_stop();
+    return ret;
+}
+
+void led_effects_stop(void)
+{
+    if (s_clock)
+    {
+        esp_timer_stop(s_clock);
+        esp_timer_delete(s_clock);
+        s_clock = NULL;
+    }
+
+    if (s_task)
+    {
+        s_running = false;
+        xTaskNotifyGive(s_task);
+        xSemaphoreTake(s_stopped, portMAX_DELAY);
+        s_task = NULL;
+    }
+    s_running = false;
+
+    if (s_stopped)
+    {
+        vSemaphoreDelete(s_stopped);
+        s_stopped = NULL;
+    }
+}
+
+esp_err_t led_effects_set_fps(uint32_t fps)
+{
+    ESP_RETURN_ON_FALSE(fps > 0 && fps <= 1000, ESP_ERR_INVALID_ARG, TAG, "Invalid FPS");
+    ESP_RETURN_ON_FALSE(s_running, ESP_ERR_INVALID_STATE, TAG, "Render task not running");
+
+    esp_timer_stop(s_clock);
+    timing_reset();
+    s_period_us = 1000000 / fps;
+    return esp_timer_start_periodic(s_clock, s_period_us);
+}
+
+esp_err_t led_effects_get_timing(led_effects_timing_t *out)
+{
+    if (!out)
+        return ESP_ERR_INVALID_ARG;
+    if (!s_running)
+        return ESP_ERR_INVALID_STATE;
+
+    taskENTER_CRITICAL(&s_timing_lock);
+    *out = s_timing;
+    out->target_period_us = s_period_us;
+    taskEXIT_CRITICAL(&s_timing_lock);
+    return ESP_OK;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdint.h>
+
+/* Fixed-point math for effects. Angles and wave phases are 8 or 16 bits
+   per turn, so they wrap for free; levels are 0-255 or 0-65535. Nothing
+   here touches the FPU. */
+
+typedef uint16_t q8_8_t;  // unsigned 8.8, e.g. beats per minute
+typedef int32_t q16_16_t; // signed 16.16
+
+#define Q8_8(x) ((q8_8_t)((x) * 256.0f + 0.5f))
+#define Q16_16(x) ((q16_16_t)((x) * 65536.0f))
+
+static inline q16_16_t q16_mul(q16_16_t a, q16_16_t b)
+{
+    return (q16_16_t)(((int64_t)a * b) >> 16);
+}
+
+/* v * scale / 256, with scale 255 leaving v unchanged */
+static inline uint8_t scale8(uint8_t v, uint8_t scale)
+{
+    return (uint8_t)(((uint16_t)v * (scale + 1u)) >> 8);
+}
+
+static inline uint16_t scale16(uint16_t v, uint16_t scale)
+{
+    return (uint16_t)(((uint32_t)v * (scale + 1u)) >> 16);
+}
+
+/* a -> b as t goes 0 -> 255 / 65535 */
+static inline uint8_t lerp8(uint8_t a, uint8_t b, uint8_t t)
+{
+    return (b >= a) ? (uint8_t)(a + scale8(b - a, t)) : (uint8_t)(a - scale8(a - b, t));
+}
+
+static inline uint16_t lerp16(uint16_t a, uint16_t b, uint16_t t)
+{
+    return (b >= a) ? (uint16_t)(a + scale16(b - a, t)) : (uint16_t)(a - scale16(a - b, t));
+}
+
+/* Sine from a 256-entry table: sin16 is -32767..32767 and interpolated,
+   sin8 is 0..255 centered on 128 (table only) */
+int16_t sin16(uint16_t angle);
+uint8_t sin8(uint8_t angle);
+
+static inline int16_t cos16(uint16_t angle)
+{
+    return sin16((uint16_t)(angle + 16384));
+}
+
+static inline uint8_t cos8(uint8_t angle)
+{
+    return sin8((uint8_t)(angle + 64));
+}
+
+/* 0 -> peak at half a turn -> 0 */
+static inline uint8_t triangle8(uint8_t phase)
+{
+    uint8_t v = (uint8_t)(phase << 1);
+    return (phase & 0x80) ? (uint8_t)(255 - v) : v;
+}
+
+static inline uint16_t triangle16(uint16_t phase)
+{
+    uint16_t v = (uint16_t)(phase << 1);
+    return (phase & 0x8000) ? (uint16_t)(65535 - v) : v;
+}
+
+/* Easing, 0 and full scale map to themselves */
+static inline uint8_t ease8_in(uint8_t x)
+{
+    return scale8(x, x);
+}
+
+static inline uint8_t ease8_out(uint8_t x)
+{
+    return (uint8_t)(255 - ease8_in(255 - x));
+}
+
+uint8_t ease8_in_out(uint8_t x); // smoothstep
+
+static inline uint16_t ease16_in(uint16_t x)
+{
+    return scale16(x, x);
+}
+
+static inline uint16_t ease16_out(uint16_t x)
+{
+    return (uint16_t)(65535 - ease16_in(65535 - x));
+}
+
+uint16_t ease16_in_out(uint16_t x); // smoothstep
+
+/* Beat generator: phase of a wave running at `bpm` (Q8.8) at time
+   `now_ms`, one turn per beat. Stateless, so every effect using the same
+   tempo stays in step. */
+uint16_t beat16(q8_8_t bpm, uint32_t now_ms);
+
+static inline uint8_t beat8(q8_8_t bpm, uint32_t now_ms)
+{
+    return (uint8_t)(beat16(bpm, now_ms) >> 8);
+}
+
+/* Sine swinging between lo and hi at `bpm` */
+uint8_t beatsin8(q8_8_t bpm, uint8_t lo, uint8_t hi, uint32_t now_ms);
+uint16_t beatsin16(q8_8_t bpm, uint16_t lo, uint16_t hi, uint32_t now_ms);
@@ -0,0 +1,81 @@
+#include "led_math.h"
+
+/* One turn of sin * 32767, plus the wrap entry for interpolation */
+static const int16_t s_sin_table[257] = {
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602,
+    6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+    12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+    18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+    23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+    27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+    32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+    32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285,
+    32137, 31971, 31785, 31580, 31356, 31113, 30852, 30571,
+    30273, 29956, 29621, 29268, 28898, 28510, 28105, 27683,
+    27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731,
+    23170, 22594, 22005, 21403, 20787, 20159, 19519, 18868,
+    18204, 17530, 16846, 16151, 15446, 14732, 14010, 13279,
+    12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179,
+    6393, 5602, 4808, 4011, 3212, 2410, 1608, 804,
+    0, -804, -1608, -2410, -3212, -4011, -4808, -5602,
+    -6393, -7179, -7962, -8739, -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
+    -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+    -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+    -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+    -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+    -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+    -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+    -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+    -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
+    -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278, -9512, -8739, -7962, -7179,
+    -6393, -5602, -4808, -4011, -3212, -2410, -1608, -804,
+    0,
+};
+
+int16_t sin16(uint16_t angle)
+{
+    int32_t a = s_sin_table[angle >> 8];
+    int32_t b = s_sin_table[(angle >> 8) + 1];
+
+    return (int16_t)(a + (((b - a) * (int32_t)(angle & 0xFF)) >> 8));
+}
+
+uint8_t sin8(uint8_t angle)
+{
+    return (uint8_t)((s_sin_table[angle] >> 8) + 128);
+}
+
+/* 3x^2 - 2x^3 */
+uint8_t ease8_in_out(uint8_t x)
+{
+    uint32_t x2 = (uint32_t)x * x;
+    return (uint8_t)((x2 * (3 * 255 - 2 * (uint32_t)x)) / (255 * 255));
+}
+
+uint16_t ease16_in_out(uint16_t x)
+{
+    uint64_t x2 = (uint64_t)x * x;
+    return (uint16_t)((x2 * (3 * 65535 - 2 * (uint64_t)x)) / ((uint64_t)65535 * 65535));
+}
+
+uint16_t beat16(q8_8_t bpm, uint32_t now_ms)
+{
+    /* turns = ms * bpm / 60000 / 256 (Q8.8) in Q16: ms * bpm * 65536 / 15360000 */
+    return (uint16_t)(((uint64_t)now_ms * bpm * 65536) / 15360000);
+}
+
+uint8_t beatsin8(q8_8_t bpm, uint8_t lo, uint8_t hi, uint32_t now_ms)
+{
+    return lerp8(lo, hi, sin8(beat8(bpm, now_ms)));
+}
+
+uint16_t beatsin16(q8_8_t bpm, uint16_t lo, uint16_t hi, uint32_t now_ms)
+{
+    uint16_t s = (uint16_t)(sin16(beat16(bpm, now_ms)) + 32768);
+    return lerp16(lo, hi, s);
+}
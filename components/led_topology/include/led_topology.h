@@ -1,27 +1,148 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
+#include "esp_err.h"
 
 /* One LED strip definition */
 typedef struct
 {
-    uint16_t led_count;
+    uint32_t led_count;
     bool reversed; // true = physical strip is wired backwards
+    int8_t gpio;   // data pin, -1 = daisy-chained after the previous strip
 } led_strip_t;
 
+/* Max named zones per topology */
+#define LED_TOPOLOGY_MAX_ZONES 16
+
+/* Named zone (tank, front wheel, underglow...): `led_count` LEDs starting
+   at LED `first` of strip `strip`, running on into the following strips
+   if needed. `first` must lie on that strip and the zone must end by the
+   last LED, otherwise init fails. Zones may overlap and need not cover
+   every LED. */
+typedef struct
+{
+    const char *name;
+    uint8_t strip;
+    uint32_t first;
+    uint32_t led_count;
+} led_zone_config_t;
+
+/* Zone resolved at init to a logical range */
+typedef struct
+{
+    const char *name;
+    uint32_t start; // logical index
+    uint32_t count;
+} led_zone_t;
+
+/* Run of consecutive logical LEDs */
+typedef struct
+{
+    uint32_t start;
+    uint32_t count;
+} led_span_t;
+
 /* Full bike LED layout */
 typedef struct
 {
     uint8_t strip_count;
     const led_strip_t *strips;
+
+    /* Optional LED positions in mm, one entry per LED in logical order
+       (structure of arrays). NULL x/y = no geometry; z NULL = flat.
+       Read by spatial queries, so they must stay valid after init. */
+    const int16_t *pos_x;
+    const int16_t *pos_y;
+    const int16_t *pos_z;
+
+    /* Optional named zones, up to LED_TOPOLOGY_MAX_ZONES */
+    const led_zone_config_t *zones;
+    uint8_t zone_count;
 } led_topology_t;
 
-/* Initialize topology */
-void led_topology_init(const led_topology_t *topo);
+/* Geometry precomputed at init, one entry per LED in logical order, so
+   spatial effects only read arrays. All values are 16-bit fixed point:
+   - x/y/z: position normalized over the layout's bounding box,
+     0 = min, 65535 = max (32768 on an axis with no extent)
+   - angle: around the bounding box centre in the x/y plane,
+     65536 = one turn, 0 = +x, counter-clockwise
+   - radius: distance from that centre in mm, 65535 = farthest LED */
+typedef struct
+{
+    const uint16_t *x;
+    const uint16_t *y;
+    const uint16_t *z; // NULL for flat layouts
+    const uint16_t *angle;
+    const uint16_t *radius;
+} led_geometry_t;
+
+/* A stretch of logical LEDs that maps to consecutive physical LEDs:
+   logical_start + i → physical_start + i * stride. Forward strips give
+   stride +1 (adjacent forward strips merge into one run), reversed strips
+   stride -1. */
+typedef struct
+{
+    uint32_t logical_start;
+    uint32_t physical_start; // physical index of logical_start
+    uint32_t length;
+    int8_t stride;           // +1 or -1
+} led_run_t;
+
+/* Run iterator state, see led_topology_runs_begin() */
+typedef struct
+{
+    uint8_t strip;
+    uint32_t base;
+} led_run_iter_t;
+
+/* Initialize topology and build the logical → physical map table
+   (4 bytes per LED). `topo` must stay valid afterwards. */
+esp_err_t led_topology_init(const led_topology_t *topo);
+
+/* Zone by name (hashed, O(1)); NULL if there is no such zone */
+const led_zone_t *led_topology_zone(const char *name);
+
+/* Zones in the order given, index < led_topology_zone_count() */
+uint8_t led_topology_zone_count(void);
+const led_zone_t *led_topology_zone_at(uint8_t index);
+
+/* Precomputed geometry, NULL when the topology has no positions */
+const led_geometry_t *led_topology_geometry(void);
+
+/* LEDs within `radius_mm` of (x, y), or inside the box [x0, x1] x
+   [y0, y1] (inclusive), in the x/y plane of the positions (z ignored).
+   Results are runs of logical indices in ascending order, written to
+   `out` up to `max_spans`. Returns the number of runs found; if that
+   exceeds `max_spans` the rest were dropped and the runs written are
+   unsorted and may be split. A uniform grid built at
+   init keeps the cost proportional to the LEDs near the query; without
+   positions nothing is found. */
+size_t led_topology_query_radius(int16_t x, int16_t y, uint16_t radius_mm,
+                                 led_span_t *out, size_t max_spans);
+size_t led_topology_query_box(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                              led_span_t *out, size_t max_spans);
 
 /* Total LEDs across all strips */
-uint16_t led_topology_total_leds(void);
+uint32_t led_topology_total_leds(void);
+
+/* Map logical index → physical WS2812 buffer index (one table load) */
+uint32_t led_topology_map(uint32_t logical_index);
+
+/* Map `count` logical indices starting at `logical_start` into `out`.
+   Returns how many were written (stops at the last LED). */
+uint32_t led_topology_map_span(uint32_t logical_start, uint32_t count, uint32_t *out);
+
+/* Walk the topology as runs, in logical order:
+       led_run_iter_t it;
+       led_run_t run;
+       led_topology_runs_begin(&it);
+       while (led_topology_runs_next(&it, &run)) { ... } */
+void led_topology_runs_begin(led_run_iter_t *it);
+bool led_topology_runs_next(led_run_iter_t *it, led_run_t *run);
 
-/* Map logical index → physical WS2812 buffer index */
-uint16_t led_topology_map(uint16_t logical_index);
+/* The whole map, indexed by logical LED (led_topology_total_leds()
+   entries), for effects that hoist the mapping out of their loops.
+   NULL before init. */
+const uint32_t *led_topology_map_table(void);
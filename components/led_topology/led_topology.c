@@ -1,55 +1,385 @@
-#include "led_topology.h"
+#include "led_topology_priv.h"
 #include "esp_log.h"
 
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
 static const char *TAG = "led_topology";
 
 static const led_topology_t *s_topology = NULL;
-static uint16_t s_total_leds = 0;
+static uint32_t s_total_leds = 0;
+
+/* Logical → physical index, one entry per LED, built once at init */
+static uint32_t *s_map = NULL;
+
+/* Geometry arrays, all in one allocation (s_geo_buf) */
+static uint16_t *s_geo_buf = NULL;
+static led_geometry_t s_geo;
+
+/* Zones and their name hash table: open addressing, slot = zone index + 1
+   (0 = empty), at most half full */
+#define ZONE_SLOTS (LED_TOPOLOGY_MAX_ZONES * 2)
+
+static led_zone_t s_zones[LED_TOPOLOGY_MAX_ZONES];
+static uint8_t s_zone_count = 0;
+static uint8_t s_zone_slots[ZONE_SLOTS];
 
-void led_topology_init(const led_topology_t *topo)
+/* ---------------- ZONES ---------------- */
+
+/* FNV-1a */
+static uint32_t zone_hash(const char *name)
 {
-    s_topology = topo;
-    s_total_leds = 0;
+    uint32_t h = 2166136261u;
 
-    for (uint8_t i = 0; i < topo->strip_count; i++)
+    while (*name)
     {
-        s_total_leds += topo->strips[i].led_count;
+        h ^= (uint8_t)*name++;
+        h *= 16777619u;
     }
 
-    ESP_LOGI(TAG, "Topology loaded: %d strips, %d total LEDs",
-             topo->strip_count, s_total_leds);
+    return h;
 }
 
-uint16_t led_topology_total_leds(void)
+/* Hash slot holding `name`, or the empty slot where it would go */
+static uint32_t zone_slot(const uint8_t *slots, const led_zone_t *zones, const char *name)
 {
-    return s_total_leds;
+    uint32_t i = zone_hash(name) & (ZONE_SLOTS - 1);
+
+    while (slots[i] && strcmp(zones[slots[i] - 1].name, name) != 0)
+        i = (i + 1) & (ZONE_SLOTS - 1);
+
+    return i;
+}
+
+static esp_err_t zones_build(const led_topology_t *topo, uint32_t total,
+                             led_zone_t *zones, uint8_t *slots)
+{
+    if (topo->zone_count > LED_TOPOLOGY_MAX_ZONES || (topo->zone_count && !topo->zones))
+        return ESP_ERR_INVALID_ARG;
+
+    for (uint8_t z = 0; z < topo->zone_count; z++)
+    {
+        const led_zone_config_t *cfg = &topo->zones[z];
+
+        if (!cfg->name || cfg->strip >= topo->strip_count)
+            return ESP_ERR_INVALID_ARG;
+
+        /* The zone must start on the strip it names; it may then run on
+           into the following strips, but not past the last LED */
+        if (cfg->first >= topo->strips[cfg->strip].led_count)
+        {
+            ESP_LOGE(TAG, "Zone '%s' starts outside strip %u", cfg->name, cfg->strip);
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        uint32_t start = cfg->first;
+        for (uint8_t i = 0; i < cfg->strip; i++)
+            start += topo->strips[i].led_count;
+
+        if (cfg->led_count > total - start)
+        {
+            ESP_LOGE(TAG, "Zone '%s' runs past the last LED", cfg->name);
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        uint32_t slot = zone_slot(slots, zones, cfg->name);
+        if (slots[slot])
+        {
+            ESP_LOGE(TAG, "Duplicate zone '%s'", cfg->name);
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        zones[z].name = cfg->name;
+        zones[z].start = start;
+        zones[z].count = cfg->led_count;
+        slots[slot] = z + 1;
+    }
+
+    return ESP_OK;
+}
+
+/* ---------------- GEOMETRY ---------------- */
+
+static void axis_range(const int16_t *v, uint32_t n, int32_t *min, int32_t *max)
+{
+    *min = INT16_MAX;
+    *max = INT16_MIN;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (v[i] < *min)
+            *min = v[i];
+        if (v[i] > *max)
+            *max = v[i];
+    }
+}
+
+static void axis_normalize(uint16_t *out, const int16_t *v, uint32_t n)
+{
+    int32_t min, max;
+    axis_range(v, n, &min, &max);
+
+    uint32_t span = (uint32_t)(max - min);
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        out[i] = span ? (uint16_t)(((uint32_t)(v[i] - min) * 65535u + span / 2) / span) : 32768;
+    }
 }
 
-uint16_t led_topology_map(uint16_t logical_index)
+/* Build normalized coordinates, angle and radius for `n` LEDs. The only
+   place atan2f / sqrtf run. */
+static uint16_t *geometry_build(const led_topology_t *topo, uint32_t n, led_geometry_t *geo)
 {
-    uint16_t base = 0;
+    size_t planes = topo->pos_z ? 5 : 4;
+    uint16_t *buf = malloc(planes * n * sizeof(uint16_t));
+    if (!buf)
+        return NULL;
 
-    for (uint8_t i = 0; i < s_topology->strip_count; i++)
+    uint16_t *x = buf, *y = buf + n, *angle = buf + 2 * n, *radius = buf + 3 * n;
+    uint16_t *z = topo->pos_z ? buf + 4 * n : NULL;
+
+    axis_normalize(x, topo->pos_x, n);
+    axis_normalize(y, topo->pos_y, n);
+    if (z)
+        axis_normalize(z, topo->pos_z, n);
+
+    /* Polar data around the bounding box centre, in mm so circles stay
+       round whatever the aspect ratio */
+    int32_t xmin, xmax, ymin, ymax;
+    axis_range(topo->pos_x, n, &xmin, &xmax);
+    axis_range(topo->pos_y, n, &ymin, &ymax);
+
+    float cx = (xmin + xmax) * 0.5f;
+    float cy = (ymin + ymax) * 0.5f;
+    float d2max = 0.0f;
+
+    for (uint32_t i = 0; i < n; i++)
     {
-        const led_strip_t *s = &s_topology->strips[i];
+        float dx = topo->pos_x[i] - cx;
+        float dy = topo->pos_y[i] - cy;
+        float d2 = dx * dx + dy * dy;
+        if (d2 > d2max)
+            d2max = d2;
+
+        float a = atan2f(dy, dx); /* -pi..pi */
+        if (a < 0.0f)
+            a += 2.0f * (float)M_PI;
+        /* 2pi wraps to 0 */
+        angle[i] = (uint16_t)(uint32_t)(a * (65536.0f / (2.0f * (float)M_PI)) + 0.5f);
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        float dx = topo->pos_x[i] - cx;
+        float dy = topo->pos_y[i] - cy;
+        radius[i] = d2max > 0.0f ? (uint16_t)(sqrtf((dx * dx + dy * dy) / d2max) * 65535.0f + 0.5f) : 0;
+    }
 
-        if (logical_index < base + s->led_count)
+    *geo = (led_geometry_t){
+        .x = x, .y = y, .z = z, .angle = angle, .radius = radius};
+    return buf;
+}
+
+/* ---------------- TOPOLOGY ---------------- */
+
+esp_err_t led_topology_init(const led_topology_t *topo)
+{
+    if (!topo)
+        return ESP_ERR_INVALID_ARG;
+
+    uint32_t total = 0;
+
+    for (uint8_t i = 0; i < topo->strip_count; i++)
+    {
+        total += topo->strips[i].led_count;
+    }
+
+    uint32_t *map = NULL;
+    if (total > 0)
+    {
+        map = malloc(total * sizeof(*map));
+        if (!map)
         {
-            uint16_t local = logical_index - base;
-
-            if (s->reversed)
-            {
-                return base + (s->led_count - 1 - local);
-            }
-            else
-            {
-                return base + local;
-            }
+            ESP_LOGE(TAG, "No memory for %lu entry map", (unsigned long)total);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    led_zone_t zones[LED_TOPOLOGY_MAX_ZONES];
+    uint8_t slots[ZONE_SLOTS] = {0};
+
+    esp_err_t err = zones_build(topo, total, zones, slots);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Invalid zone list");
+        free(map);
+        return err;
+    }
+
+    uint16_t *geo_buf = NULL;
+    led_geometry_t geo = {0};
+
+    if (topo->pos_x && topo->pos_y && total > 0)
+    {
+        geo_buf = geometry_build(topo, total, &geo);
+        if (!geo_buf)
+        {
+            ESP_LOGE(TAG, "No memory for geometry");
+            free(map);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    if (geo_buf)
+        err = led_topology_grid_build(topo->pos_x, topo->pos_y, total);
+    else
+        led_topology_grid_free();
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "No memory for spatial grid");
+        free(geo_buf);
+        free(map);
+        return err;
+    }
+
+    uint32_t base = 0;
+
+    for (uint8_t i = 0; i < topo->strip_count; i++)
+    {
+        const led_strip_t *s = &topo->strips[i];
+
+        for (uint32_t local = 0; local < s->led_count; local++)
+        {
+            map[base + local] = s->reversed
+                                    ? base + (s->led_count - 1 - local)
+                                    : base + local;
         }
 
         base += s->led_count;
     }
 
+    free(s_map);
+    free(s_geo_buf);
+    s_map = map;
+    s_geo_buf = geo_buf;
+    s_geo = geo;
+    memcpy(s_zones, zones, topo->zone_count * sizeof(zones[0]));
+    memcpy(s_zone_slots, slots, sizeof(slots));
+    s_zone_count = topo->zone_count;
+    s_topology = topo;
+    s_total_leds = total;
+
+    ESP_LOGI(TAG, "Topology loaded: %d strips, %lu total LEDs, %d zones%s",
+             topo->strip_count, (unsigned long)s_total_leds, s_zone_count,
+             geo_buf ? (geo.z ? ", 3D" : ", 2D") : "");
+    return ESP_OK;
+}
+
+const led_zone_t *led_topology_zone(const char *name)
+{
+    if (!name || s_zone_count == 0)
+        return NULL;
+
+    uint8_t z = s_zone_slots[zone_slot(s_zone_slots, s_zones, name)];
+    return z ? &s_zones[z - 1] : NULL;
+}
+
+uint8_t led_topology_zone_count(void)
+{
+    return s_zone_count;
+}
+
+const led_zone_t *led_topology_zone_at(uint8_t index)
+{
+    return (index < s_zone_count) ? &s_zones[index] : NULL;
+}
+
+const led_geometry_t *led_topology_geometry(void)
+{
+    return s_geo_buf ? &s_geo : NULL;
+}
+
+uint32_t led_topology_total_leds(void)
+{
+    return s_total_leds;
+}
+
+uint32_t led_topology_map(uint32_t logical_index)
+{
+    if (s_total_leds == 0)
+        return 0;
+
     /* Out of bounds → clamp */
-    return s_total_leds - 1;
+    if (logical_index >= s_total_leds)
+        return s_total_leds - 1;
+
+    return s_map[logical_index];
+}
+
+uint32_t led_topology_map_span(uint32_t logical_start, uint32_t count, uint32_t *out)
+{
+    if (logical_start >= s_total_leds)
+        return 0;
+
+    if (count > s_total_leds - logical_start)
+        count = s_total_leds - logical_start;
+
+    memcpy(out, &s_map[logical_start], count * sizeof(*out));
+    return count;
+}
+
+void led_topology_runs_begin(led_run_iter_t *it)
+{
+    it->strip = 0;
+    it->base = 0;
+}
+
+bool led_topology_runs_next(led_run_iter_t *it, led_run_t *run)
+{
+    if (!s_topology)
+        return false;
+
+    /* Empty strips produce no run */
+    while (it->strip < s_topology->strip_count &&
+           s_topology->strips[it->strip].led_count == 0)
+    {
+        it->strip++;
+    }
+
+    if (it->strip >= s_topology->strip_count)
+        return false;
+
+    const led_strip_t *s = &s_topology->strips[it->strip++];
+
+    run->logical_start = it->base;
+    run->length = s->led_count;
+
+    if (s->reversed)
+    {
+        run->physical_start = it->base + s->led_count - 1;
+        run->stride = -1;
+    }
+    else
+    {
+        /* Forward strips back to back are contiguous on both sides */
+        while (it->strip < s_topology->strip_count &&
+               !s_topology->strips[it->strip].reversed)
+        {
+            run->length += s_topology->strips[it->strip++].led_count;
+        }
+
+        run->physical_start = it->base;
+        run->stride = 1;
+    }
+
+    it->base += run->length;
+    return true;
+}
+
+const uint32_t *led_topology_map_table(void)
+{
+    return s_map;
 }
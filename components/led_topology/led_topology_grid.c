@@ -0,0 +1,251 @@
+#include "led_topology_priv.h"
+#include "esp_log.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const char *TAG = "led_topology";
+
+/* Aim for this many LEDs per grid cell */
+#define GRID_LEDS_PER_CELL 4
+
+/* Uniform grid over the layout's x/y bounding box. Every cell lists its
+   LEDs as runs of consecutive logical indices (LEDs along a strip share
+   cells, so a cell is usually one or two runs): cell c owns
+   s_spans[s_cell_first[c] .. s_cell_first[c + 1]). */
+static const int16_t *s_x = NULL;
+static const int16_t *s_y = NULL;
+static int32_t s_x0, s_y0;  /* grid origin, mm */
+static uint32_t s_cell_mm;
+static uint32_t s_cols, s_rows;
+static uint32_t *s_cell_first = NULL;
+static led_span_t *s_spans = NULL;
+
+void led_topology_grid_free(void)
+{
+    free(s_cell_first);
+    free(s_spans);
+    s_cell_first = NULL;
+    s_spans = NULL;
+    s_x = NULL;
+    s_y = NULL;
+    s_cols = 0;
+    s_rows = 0;
+}
+
+static inline uint32_t grid_cell(int16_t x, int16_t y)
+{
+    return ((y - s_y0) / s_cell_mm) * s_cols + (x - s_x0) / s_cell_mm;
+}
+
+esp_err_t led_topology_grid_build(const int16_t *x, const int16_t *y, uint32_t n)
+{
+    led_topology_grid_free();
+
+    int32_t xmin = INT16_MAX, xmax = INT16_MIN, ymin = INT16_MAX, ymax = INT16_MIN;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (x[i] < xmin) xmin = x[i];
+        if (x[i] > xmax) xmax = x[i];
+        if (y[i] < ymin) ymin = y[i];
+        if (y[i] > ymax) ymax = y[i];
+    }
+
+    /* Square cells sized for ~GRID_LEDS_PER_CELL LEDs each; the second
+       bound keeps long thin layouts (a single straight strip) from
+       exploding into one cell per mm */
+    uint32_t w = xmax - xmin + 1, h = ymax - ymin + 1;
+    uint32_t cells = n / GRID_LEDS_PER_CELL + 1;
+    uint32_t by_area = (uint32_t)ceilf(sqrtf((float)w * h / cells));
+    uint32_t by_length = ((w > h ? w : h) + cells - 1) / cells;
+
+    s_cell_mm = by_area > by_length ? by_area : by_length;
+    if (s_cell_mm == 0)
+        s_cell_mm = 1;
+    s_x0 = xmin;
+    s_y0 = ymin;
+    s_cols = (w + s_cell_mm - 1) / s_cell_mm;
+    s_rows = (h + s_cell_mm - 1) / s_cell_mm;
+
+    uint32_t grid_cells = s_cols * s_rows;
+    s_cell_first = calloc(grid_cells + 1, sizeof(uint32_t));
+    uint32_t *order = malloc(n * sizeof(uint32_t));
+    if (!s_cell_first || !order)
+        goto no_mem;
+
+    /* Counting sort of the LEDs by cell, stable so each cell stays in
+       logical order: count, prefix sum, place */
+    for (uint32_t i = 0; i < n; i++)
+        s_cell_first[grid_cell(x[i], y[i]) + 1]++;
+    for (uint32_t c = 0; c < grid_cells; c++)
+        s_cell_first[c + 1] += s_cell_first[c];
+    for (uint32_t i = 0; i < n; i++)
+        order[s_cell_first[grid_cell(x[i], y[i])]++] = i;
+
+    /* Placing advanced every start to the next cell's; shift back */
+    memmove(&s_cell_first[1], &s_cell_first[0], grid_cells * sizeof(uint32_t));
+    s_cell_first[0] = 0;
+
+    /* Compress each cell's LED list into runs (at most one per LED) */
+    s_spans = malloc(n * sizeof(led_span_t));
+    if (!s_spans)
+        goto no_mem;
+
+    uint32_t spans = 0;
+    for (uint32_t c = 0; c < grid_cells; c++)
+    {
+        uint32_t first = spans;
+
+        for (uint32_t k = s_cell_first[c]; k < s_cell_first[c + 1]; k++)
+        {
+            if (spans > first && s_spans[spans - 1].start + s_spans[spans - 1].count == order[k])
+                s_spans[spans - 1].count++;
+            else
+                s_spans[spans++] = (led_span_t){.start = order[k], .count = 1};
+        }
+
+        s_cell_first[c] = first;
+    }
+    s_cell_first[grid_cells] = spans;
+    free(order);
+
+    led_span_t *fit = realloc(s_spans, spans * sizeof(led_span_t));
+    if (fit)
+        s_spans = fit;
+
+    s_x = x;
+    s_y = y;
+
+    ESP_LOGI(TAG, "Spatial grid: %lux%lu cells of %lu mm, %lu runs",
+             (unsigned long)s_cols, (unsigned long)s_rows,
+             (unsigned long)s_cell_mm, (unsigned long)spans);
+    return ESP_OK;
+
+no_mem:
+    free(order);
+    led_topology_grid_free();
+    return ESP_ERR_NO_MEM;
+}
+
+/* ---------------- QUERIES ---------------- */
+
+/* Append LED `i` to the result, growing the last span when it continues
+   it. Counts spans past `max` without writing them. */
+static inline void span_add(led_span_t *out, size_t max, size_t *found, uint32_t i)
+{
+    if (*found && *found <= max && out[*found - 1].start + out[*found - 1].count == i)
+    {
+        out[*found - 1].count++;
+        return;
+    }
+
+    if (*found < max)
+        out[*found] = (led_span_t){.start = i, .count = 1};
+    (*found)++;
+}
+
+/* Grid cell range covering [lo, hi] on one axis; false if it misses the grid */
+static bool cell_range(int32_t lo, int32_t hi, int32_t origin, uint32_t count,
+                       uint32_t *first, uint32_t *last)
+{
+    int32_t a = (lo - origin) < 0 ? 0 : (lo - origin) / (int32_t)s_cell_mm;
+    int32_t b = (hi - origin) < 0 ? -1 : (hi - origin) / (int32_t)s_cell_mm;
+
+    if (b < a || a >= (int32_t)count)
+        return false;
+
+    *first = a;
+    *last = (b >= (int32_t)count) ? count - 1 : (uint32_t)b;
+    return true;
+}
+
+static int span_cmp(const void *a, const void *b)
+{
+    uint32_t sa = ((const led_span_t *)a)->start, sb = ((const led_span_t *)b)->start;
+    return (sa > sb) - (sa < sb);
+}
+
+/* Cells are visited row by row, so a strip crossing several cells comes
+   out in pieces: sort by start and join the pieces back up */
+static size_t spans_merge(led_span_t *out, size_t count)
+{
+    if (count < 2)
+        return count;
+
+    qsort(out, count, sizeof(*out), span_cmp);
+
+    size_t w = 0;
+    for (size_t k = 1; k < count; k++)
+    {
+        if (out[w].start + out[w].count == out[k].start)
+            out[w].count += out[k].count;
+        else
+            out[++w] = out[k];
+    }
+
+    return w + 1;
+}
+
+/* Visit every LED in the cells touching the box, keep those inside the
+   circle (r2 >= 0) or the box (r2 < 0) */
+static size_t grid_query(int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                         int32_t cx, int32_t cy, int64_t r2,
+                         led_span_t *out, size_t max)
+{
+    uint32_t c0, c1, r0, r1;
+    size_t found = 0;
+
+    if (!s_cell_first ||
+        !cell_range(x0, x1, s_x0, s_cols, &c0, &c1) ||
+        !cell_range(y0, y1, s_y0, s_rows, &r0, &r1))
+    {
+        return 0;
+    }
+
+    for (uint32_t row = r0; row <= r1; row++)
+    {
+        for (uint32_t col = c0; col <= c1; col++)
+        {
+            uint32_t c = row * s_cols + col;
+
+            for (uint32_t k = s_cell_first[c]; k < s_cell_first[c + 1]; k++)
+            {
+                uint32_t end = s_spans[k].start + s_spans[k].count;
+
+                for (uint32_t i = s_spans[k].start; i < end; i++)
+                {
+                    bool inside;
+
+                    if (r2 >= 0)
+                    {
+                        int64_t dx = s_x[i] - cx, dy = s_y[i] - cy;
+                        inside = dx * dx + dy * dy <= r2;
+                    }
+                    else
+                    {
+                        inside = s_x[i] >= x0 && s_x[i] <= x1 && s_y[i] >= y0 && s_y[i] <= y1;
+                    }
+
+                    if (inside)
+                        span_add(out, max, &found, i);
+                }
+            }
+        }
+    }
+
+    return (found <= max) ? spans_merge(out, found) : found;
+}
+
+size_t led_topology_query_radius(int16_t x, int16_t y, uint16_t radius_mm,
+                                 led_span_t *out, size_t max_spans)
+{
+    return grid_query(x - radius_mm, y - radius_mm, x + radius_mm, y + radius_mm,
+                      x, y, (int64_t)radius_mm * radius_mm, out, max_spans);
+}
+
+size_t led_topology_query_box(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                              led_span_t *out, size_t max_spans)
+{
+    return grid_query(x0, y0, x1, y1, 0, 0, -1, out, max_spans);
+}
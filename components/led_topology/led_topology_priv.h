@@ -0,0 +1,13 @@
+#pragma once
+
+/* Internal interface between the topology core (led_topology.c) and the
+   spatial index (led_topology_grid.c). */
+
+#include "led_topology.h"
+
+/* Build the uniform grid over the x/y positions of `n` LEDs. The position
+   arrays must stay valid until the next build. */
+esp_err_t led_topology_grid_build(const int16_t *x, const int16_t *y, uint32_t n);
+
+/* Drop the grid; queries return nothing until the next build */
+void led_topology_grid_free(void);
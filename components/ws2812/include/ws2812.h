@@ -2,14 +2,122 @@
 
 #include "esp_err.h"
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
+#include "sdkconfig.h"
+#include "ws2812_color.h"
+#include "ws2812_chip.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+// No GPIO matrix on the host: pins are only labels in the capture
+typedef int gpio_num_t;
+#define GPIO_NUM_NC (-1)
+#else
 #include "hal/gpio_types.h"
+#endif
+
+// Frame completion callback, called from the output ISR once the last bit of a
+// frame has left the GPIO. Return true if a higher priority task was woken
+// (e.g. by vTaskNotifyGiveFromISR), false otherwise. With the SPI backend
+// the ISR may run with the flash cache off, so mark the callback IRAM_ATTR.
+typedef bool (*ws2812_done_cb_t)(void *user_ctx);
+
+// Max strips driven in parallel (one RMT TX channel each)
+#define WS2812_MAX_STRIPS 4
+
+// Max strips on the LCD_CAM parallel backend (one bus data line each)
+#define WS2812_LCD_MAX_STRIPS 16
+
+// How the RMT backend turns bytes into symbols
+typedef enum
+{
+    // rmt_bytes_encoder expands each bit inside the RMT ISR, one memory
+    // block at a time. Smallest RAM use (3 bytes per LED). Large frames
+    // live in PSRAM and are streamed through a ring of 64-LED chunks in
+    // internal RAM that a feeder task refills, so internal RAM use does not
+    // grow with the LED count. The ISR only reads PSRAM if the feeder falls
+    // behind (see bounce_underruns).
+    WS2812_ENCODER_BYTES = 0,
+
+    // The whole frame is expanded to symbols through a byte -> 8 symbol
+    // table on show, on the render core. The ISR only copies symbols into
+    // the channel memory, so refill interrupts drop sharply on the DMA
+    // channel (1024-symbol blocks). Channels without DMA get the spare RMT
+    // memory blocks, which only exist with one or two strips on the S3;
+    // without one a strip runs in bytes mode. Costs 96 bytes of internal
+    // RAM per LED; a strip whose symbols do not fit also runs in bytes mode.
+    WS2812_ENCODER_LUT,
+} ws2812_encoder_mode_t;
+
+// One physical strip on its own data pin
+typedef struct
+{
+    gpio_num_t gpio;
+    uint32_t led_count;
+    ws2812_encoder_mode_t encoder; // RMT backend only
+    ws2812_chip_t chip;            // bit and latch timing, default WS2812B
+} ws2812_strip_config_t;
+
+// Output interrupt load of one strip
+typedef struct
+{
+    uint32_t encoder_calls;     // encoder runs in the last frame (first fill + one per refill IRQ)
+    uint32_t encoder_calls_max; // worst frame so far
+    uint32_t frames;            // frames completed
+    uint32_t bounce_underruns;  // streamed chunks the ISR had to convert itself (feeder late)
+} ws2812_isr_stats_t;
+
+typedef struct ws2812_strip *ws2812_strip_handle_t;
+
+// LCD_CAM parallel bus: every strip sits on one data line and all of them
+// are clocked out together by DMA. The bus runs one bit clock for every
+// lane, so only the latch time follows the chip profiles, and RGBW chips
+// are not supported.
+typedef struct
+{
+    const ws2812_strip_config_t *strips; // led_count 0 = unused line (kept low)
+    size_t strip_count;                  // 8 or 16 (bus width)
+    gpio_num_t wr_gpio;                  // bus clock, spare pin (LEDs ignore it)
+    gpio_num_t dc_gpio;                  // bus D/C, spare pin (LEDs ignore it)
+} ws2812_lcd_config_t;
+
+// Clocked LEDs (APA102 / SK9822) on SPI with DMA: data + clock pin, no
+// bit timing, so short strips refresh at several kHz. The frame buffer and
+// every pixel / span API work exactly as for WS2812 strips.
+#define WS2812_SPI_CLOCK_HZ_DEFAULT 10000000
+
+typedef struct
+{
+    gpio_num_t data_gpio;
+    gpio_num_t clock_gpio;
+    uint32_t led_count;
+    uint32_t clock_hz; // 0 = WS2812_SPI_CLOCK_HZ_DEFAULT; APA102 takes up to ~20 MHz
+    uint8_t current;   // 5-bit per-pixel drive current (1-31), 0 = 31 (full)
+    int spi_host;      // spi_host_device_t, 0 = SPI2_HOST
+} ws2812_spi_config_t;
 
 // Initialize WS2812 strip using RMT Encoder API.
 // gpio: data pin for the strip
 // led_count: number of LEDs in the strip
 esp_err_t ws2812_init(gpio_num_t gpio, uint32_t led_count);
 
+// Initialize several strips, each on its own RMT channel and with the
+// fastest timing its chip allows. All strips start transmitting on the
+// same tick, so the frame time is set by the slowest strip. Strips are
+// laid out back to back in the frame buffer in the given order: pixel
+// index = strip offset + index within the strip. Frame buffers of a few
+// KB and up are placed in PSRAM when available.
+esp_err_t ws2812_init_strips(const ws2812_strip_config_t *strips, size_t strip_count);
+
+// Initialize up to 16 strips on the LCD_CAM peripheral (ESP32-S3). Same
+// frame buffer layout as ws2812_init_strips(); the frame is bit-transposed
+// into parallel bus words on show.
+esp_err_t ws2812_init_lcd(const ws2812_lcd_config_t *cfg);
+
+// Initialize one APA102 / SK9822 strip on an SPI bus (DMA). The 8-bit
+// brightness / gamma tables still apply; `current` scales every LED on top.
+esp_err_t ws2812_init_spi(const ws2812_spi_config_t *cfg);
+
 // Deinit and free resources
 void ws2812_deinit(void);
 
@@ -23,8 +131,147 @@ void ws2812_fill(uint8_t r, uint8_t g, uint8_t b);
 // Clear (set all pixels to 0,0,0) and keep in RAM (call show to apply)
 void ws2812_clear(void);
 
-// Push current frame buffer to the LEDs
+// Write `count` RGB pixels starting at `start` in one call (RAM only).
+// Pixels past the end of the strip are dropped.
+void ws2812_write_span(uint32_t start, const rgb_t *src, uint32_t count);
+
+// Same as ws2812_write_span() in reverse order: src[0] lands on pixel
+// start + count - 1, for strips wired backwards. Pixels past the end of
+// the strip are dropped (from the start of `src`).
+void ws2812_write_span_reverse(uint32_t start, const rgb_t *src, uint32_t count);
+
+// Set `count` pixels starting at `start` to one color (RAM only)
+void ws2812_fill_span(uint32_t start, uint32_t count, uint8_t r, uint8_t g, uint8_t b);
+
+// Switch to a 16-bit working buffer (call after init). Every show then
+// dithers it down to 8 bits with per-LED error accumulation, so slow fades
+// keep their depth at ~100 FPS. Gamma (interpolated 16-bit curves) and
+// brightness are applied before dithering. 8-bit writes are widened (x257).
+// Costs 9 extra bytes per LED and 1.5 KB of internal RAM for the curves.
+esp_err_t ws2812_enable_16bit(bool enable);
+
+// 16-bit pixel writes. Without the 16-bit buffer they are truncated to 8 bits.
+void ws2812_set_pixel16(uint32_t index, uint16_t r, uint16_t g, uint16_t b);
+void ws2812_write_span16(uint32_t start, const rgb16_t *src, uint32_t count);
+void ws2812_write_span16_reverse(uint32_t start, const rgb16_t *src, uint32_t count);
+
+// Global brightness (0-255, default 255). Applied while the frame is
+// encoded for output, so the frame buffer keeps full-scale values and a
+// change costs nothing until the next show.
+void ws2812_set_brightness(uint8_t brightness);
+uint8_t ws2812_get_brightness(void);
+
+// Per-channel gamma applied at output together with brightness
+// (1.0 = linear, the default; ~2.2-2.8 suits WS2812). In 16-bit mode it is
+// applied in 16 bits, ahead of the dither.
+void ws2812_set_gamma(float gamma_r, float gamma_g, float gamma_b);
+
+// Push current frame buffer to the LEDs and block until it is on the wire
 esp_err_t ws2812_show(void);
 
-// Get current LED count
+// Latch the frame buffer and start transmitting it in the background.
+// Returns as soon as the transfer is queued, so the next frame can be
+// rendered while this one is sent. Only waits if the previous frame is
+// still in flight.
+// If nothing was written since the last show (and no dither pattern is
+// running) the frame is skipped: ESP_OK is returned, nothing is sent and
+// the done callback does not fire. See ws2812_set_keepalive_ms().
+esp_err_t ws2812_show_async(void);
+
+// Send a caller-owned frame of ws2812_get_count() packed pixels in `fmt`
+// order (e.g. a stored effect frame, WS2812_FMT_RGB) without copying it
+// into the frame buffer. The color-order swizzle and the brightness/gamma
+// correction happen as the RMT encodes it, one small chunk at a time.
+// Returns once the transfer is queued; `frame` must stay valid and
+// unchanged until ws2812_wait_done() or the done callback.
+// The pixel order is the physical one: only use it directly when the
+// topology maps logical index i to pixel i. With a power limit set, or for
+// RGB frames on the LCD backend, the frame is copied into the frame buffer
+// first (same result, one extra pass). WS2812_ENCODER_LUT channels expand
+// it into symbols on show as usual.
+esp_err_t ws2812_show_external(const uint8_t *frame, ws2812_pixel_fmt_t fmt);
+
+// Wait for the frame started by ws2812_show_async() (-1 = wait forever)
+esp_err_t ws2812_wait_done(int timeout_ms);
+
+// Register a callback fired (in ISR context) when a frame has been sent.
+// Pass NULL to remove it.
+void ws2812_set_done_callback(ws2812_done_cb_t cb, void *user_ctx);
+
+// Current model for the limiter: mA drawn by one color channel at full
+// duty, and quiescent current per LED. Defaults are typical 5 V WS2812B.
+#define WS2812_POWER_MA_RED   16
+#define WS2812_POWER_MA_GREEN 11
+#define WS2812_POWER_MA_BLUE  15
+#define WS2812_POWER_IDLE_UA  1000
+
+typedef struct
+{
+    uint16_t ma_red;
+    uint16_t ma_green;
+    uint16_t ma_blue;
+    uint16_t idle_ua_per_led;
+} ws2812_power_model_t;
+
+// Cap the estimated LED current at `budget_ma` (0 = off). When a frame
+// would exceed it, show lowers the output brightness just enough; the
+// frame buffer is untouched. The estimate is maintained incrementally by
+// every pixel write, so the check costs O(1) per frame. model = NULL uses
+// the WS2812B defaults above.
+esp_err_t ws2812_set_power_limit(uint32_t budget_ma, const ws2812_power_model_t *model);
+
+// Estimated current of the last frame sent, after limiting (0 when off)
+uint32_t ws2812_get_power_ma(void);
+
+// Resend an unchanged frame at least this often (default 1000 ms), so
+// LEDs that glitched or were hot-plugged recover. 0 = never skip frames.
+void ws2812_set_keepalive_ms(uint32_t period_ms);
+
+// Frames skipped by show because nothing changed
+uint32_t ws2812_get_skipped_frames(void);
+
+// Get current LED count (all strips)
 uint32_t ws2812_get_count(void);
+
+// Strip instances, in the order given to ws2812_init_strips()
+size_t ws2812_get_strip_count(void);
+ws2812_strip_handle_t ws2812_get_strip(size_t index);
+uint32_t ws2812_strip_get_offset(ws2812_strip_handle_t strip);
+uint32_t ws2812_strip_get_count(ws2812_strip_handle_t strip);
+gpio_num_t ws2812_strip_get_gpio(ws2812_strip_handle_t strip);
+ws2812_chip_t ws2812_strip_get_chip(ws2812_strip_handle_t strip);
+
+// Highest frame rate the current strips can sustain on the wire
+uint32_t ws2812_get_max_fps(void);
+
+// Transmit timing, see ws2812_enable_stats()
+typedef struct
+{
+    uint32_t frames;       // frames sent since stats were enabled / reset
+    uint32_t show_min_us;  // time in show: waiting, correction, latch, queueing
+    uint32_t show_avg_us;
+    uint32_t show_max_us;
+    uint32_t show_p99_us;  // from a log histogram, at most 12.5% high
+    uint32_t wait_avg_us;  // part of show spent waiting for the previous frame
+    uint32_t wait_max_us;
+    uint32_t latch_avg_us; // part of show spent latching and queueing the frame
+    uint32_t latch_max_us;
+    uint32_t queue_full;   // shows that found the previous frame still on the wire
+    uint32_t tx_errors;    // failed transmits (RMT / bus errors)
+    uint32_t bytes_per_s;  // wire bytes sent per second, averaged since enable / reset
+    int64_t last_show_us;  // esp_timer time the last frame was handed to the output
+    int64_t last_done_us;  // esp_timer time the last frame left the wire
+} ws2812_stats_t;
+
+// Opt-in transmit statistics (off by default). Enabling resets them. The
+// cost is a few esp_timer reads and a histogram increment per shown frame,
+// cheap enough to leave on in production.
+void ws2812_enable_stats(bool enable);
+void ws2812_reset_stats(void);
+
+// Snapshot of the statistics; ESP_ERR_INVALID_STATE if they are off.
+// Safe from any task, though fields may be one frame apart.
+esp_err_t ws2812_get_stats(ws2812_stats_t *out);
+
+// Encoder runs per frame for one strip, to compare encoder modes
+esp_err_t ws2812_get_isr_stats(size_t strip_index, ws2812_isr_stats_t *out);
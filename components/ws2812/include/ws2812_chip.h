@@ -0,0 +1,42 @@
+#pragma once
+
+// Timing profiles for the WS2812-family chips we fit. Plain C with no
+// driver dependencies, so the frame-rate figures also build for the host.
+
+#include <stdint.h>
+
+typedef enum
+{
+    WS2812_CHIP_WS2812B = 0, // default
+    WS2812_CHIP_WS2812C_2020,
+    WS2812_CHIP_WS2813,
+    WS2812_CHIP_SK6812,
+    WS2812_CHIP_SK6812_RGBW, // 4 bytes per LED on the wire (GRBW)
+    WS2812_CHIP_COUNT,
+} ws2812_chip_t;
+
+// Shortest bit and latch timing each chip's datasheet allows, with some
+// margin, rounded to the 100 ns RMT tick.
+typedef struct
+{
+    const char *name;     // as used in system.json ("ws2812b", ...)
+    uint16_t t0h_ns;
+    uint16_t t0l_ns;
+    uint16_t t1h_ns;
+    uint16_t t1l_ns;
+    uint16_t reset_us;    // line low time that latches the frame
+    uint8_t bytes_per_led;
+} ws2812_chip_profile_t;
+
+// Profile for `chip`; unknown values fall back to the WS2812B profile
+const ws2812_chip_profile_t *ws2812_chip_profile(ws2812_chip_t chip);
+
+// Look a chip up by profile name; returns WS2812_CHIP_COUNT if unknown
+ws2812_chip_t ws2812_chip_from_name(const char *name);
+
+// Wire time of one frame of `led_count` LEDs, worst case (every bit a
+// long bit), including the latch
+uint32_t ws2812_chip_frame_us(ws2812_chip_t chip, uint32_t led_count);
+
+// Highest frame rate one strip of `led_count` LEDs can sustain
+uint32_t ws2812_chip_max_fps(ws2812_chip_t chip, uint32_t led_count);
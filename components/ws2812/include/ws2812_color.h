@@ -0,0 +1,83 @@
+#pragma once
+
+// Pixel type and color-order kernels used by the ws2812 frame buffer.
+// Plain C with no driver dependencies, so they also build for the host.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct
+{
+    uint8_t r, g, b;
+} rgb_t;
+
+_Static_assert(sizeof(rgb_t) == 3, "rgb_t must be packed RGB bytes");
+
+// Byte order of packed 3-byte pixels handed to the driver
+typedef enum
+{
+    WS2812_FMT_GRB = 0, // wire order, as in the frame buffer
+    WS2812_FMT_RGB,     // rgb_t arrays, stored effect frames
+} ws2812_pixel_fmt_t;
+
+// 16-bit linear pixel (0-65535 = LED PWM duty)
+typedef struct
+{
+    uint16_t r, g, b;
+} rgb16_t;
+
+// RGB pixels -> GRB wire bytes. SWAR: 4 pixels (three 32-bit words) per
+// step, tail done per pixel. dst and src must not overlap.
+void ws2812_rgb_to_grb(uint8_t *dst, const rgb_t *src, size_t count);
+
+// Scalar reference for ws2812_rgb_to_grb
+void ws2812_rgb_to_grb_ref(uint8_t *dst, const rgb_t *src, size_t count);
+
+// Same, last source pixel first (strips wired backwards):
+// dst pixel i = src[count - 1 - i]
+void ws2812_rgb_to_grb_rev(uint8_t *dst, const rgb_t *src, size_t count);
+
+// Write `count` GRB pixels of one color, one 12-byte pattern per 4 pixels
+void ws2812_grb_fill(uint8_t *dst, rgb_t color, size_t count);
+
+// Per-channel output table: gamma curve (1.0 = linear) scaled by a 0-255
+// brightness, rounded to nearest.
+void ws2812_build_correction(uint8_t table[256], float gamma, uint8_t brightness);
+
+// Copy GRB bytes through per-channel tables in one pass; lut[c] maps byte
+// c of every GRB triplet. len must be a multiple of 3.
+void ws2812_correct_grb(uint8_t *dst, const uint8_t *src, size_t len,
+                        const uint8_t lut[3][256]);
+
+// Packed pixels in `fmt` order -> wire bytes: GRB when bytes_per_led is
+// 3, GRBW when it is 4 (the common part of the three channels moves to the
+// white LED). `lut` (may be NULL) maps the G, R, B bytes first, as in
+// ws2812_correct_grb.
+void ws2812_pixels_to_wire(uint8_t *dst, const uint8_t *src, size_t count,
+                           ws2812_pixel_fmt_t fmt, const uint8_t lut[3][256],
+                           uint8_t bytes_per_led);
+
+// 16-bit GRB working buffer helpers (8-bit inputs are widened by x257)
+void ws2812_rgb16_to_grb16(uint16_t *dst, const rgb16_t *src, size_t count);
+void ws2812_rgb16_to_grb16_rev(uint16_t *dst, const rgb16_t *src, size_t count);
+void ws2812_rgb_to_grb16(uint16_t *dst, const rgb_t *src, size_t count);
+void ws2812_rgb_to_grb16_rev(uint16_t *dst, const rgb_t *src, size_t count);
+void ws2812_grb16_fill(uint16_t *dst, rgb16_t color, size_t count);
+
+// 16-bit gamma curve (1.0 = linear) as 256 linear segments: table[k] is
+// the output for input k * 256, table[256] the one for full scale.
+#define WS2812_GAMMA16_POINTS 257
+void ws2812_build_gamma16(uint16_t table[WS2812_GAMMA16_POINTS], float gamma);
+
+// Temporal dithering, 16-bit -> 8-bit. Each value goes through `lut`
+// (may be NULL = linear; lut[c] maps value c of every GRB triplet, len
+// must then be a multiple of 3) and is scaled by `scale` (Q8, 256 = 1.0)
+// onto 8-bit steps of 257 (65535 -> 255.0), then the fraction left over
+// from earlier frames in err[i] is added before truncating, and the new
+// fraction is stored back. Over a few frames the LED averages the full
+// 16-bit value; widened 8-bit values (x257) at full scale come out exact.
+// Returns true if any scaled value has a fractional part, i.e. the output
+// will keep changing from frame to frame even if the input does not.
+bool ws2812_dither16(uint8_t *dst, const uint16_t *src, uint8_t *err, size_t len,
+                     const uint16_t lut[3][WS2812_GAMMA16_POINTS], uint16_t scale);
@@ -0,0 +1,54 @@
+#pragma once
+
+// Host backend (linux target). Stands in for the RMT behind the normal
+// ws2812.h API: every shown frame is converted to the exact wire bytes
+// the LEDs would receive and kept in a ring buffer and/or appended to a
+// capture file, stamped with simulated wire timing from the chip profiles.
+// ws2812_init() / ws2812_init_strips() / ws2812_init_lcd() pick this
+// backend on the host with the defaults below.
+
+#include "ws2812.h"
+
+// Capture file layout, little-endian:
+//   header: "WS2C", u16 version, u16 strip_count,
+//           strip_count x { u32 led_count, u8 bytes_per_led, u8 chip, u16 0 }
+//   frame:  i64 wire_start_us, u32 wire_us, u32 wire_bytes, wire bytes
+// Wire bytes are every strip's corrected GRB(W) data back to back, in
+// strip order.
+#define WS2812_HOST_CAPTURE_MAGIC "WS2C"
+#define WS2812_HOST_CAPTURE_VERSION 1
+
+#define WS2812_HOST_RING_FRAMES_DEFAULT 8
+
+typedef struct
+{
+    size_t ring_frames;       // frames kept in memory (at least 1)
+    const char *capture_path; // binary capture file, NULL = none
+    // false: run at full speed, frames are stamped with the time they would
+    //        have gone out, but nothing waits for it
+    // true:  show and wait_done block for the simulated wire time, as on
+    //        the chip
+    bool realtime;
+} ws2812_host_config_t;
+
+// One frame as it went out on the (simulated) wire
+typedef struct
+{
+    const uint8_t *wire; // wire bytes, as in the capture file
+    uint32_t wire_bytes;
+    int64_t start_us;    // simulated start of transmission
+    uint32_t wire_us;    // simulated wire time, latch included
+    uint32_t seq;        // frame number since init, from 0
+} ws2812_host_frame_t;
+
+// Initialize strips on the host backend. cfg = NULL uses the defaults
+// (WS2812_HOST_RING_FRAMES_DEFAULT frames, no file, full speed).
+esp_err_t ws2812_init_host(const ws2812_strip_config_t *strips, size_t strip_count,
+                           const ws2812_host_config_t *cfg);
+
+// Frame sent `age` shows ago (0 = latest). ESP_ERR_NOT_FOUND once it has
+// dropped out of the ring. `wire` stays valid until the ring wraps.
+esp_err_t ws2812_host_get_frame(size_t age, ws2812_host_frame_t *out);
+
+// Frames sent since init
+uint32_t ws2812_host_get_frame_count(void);
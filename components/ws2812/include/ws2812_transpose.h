@@ -0,0 +1,34 @@
+#pragma once
+
+// Bit-transpose kernels for parallel (LCD_CAM / I2S) WS2812 output.
+// Plain C with no driver dependencies, so they build and benchmark on the
+// host as well as on the target.
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Max lanes (strips) on one parallel bus
+#define WS2812_TRANSPOSE_MAX_LANES 16
+
+// Bus words per WS2812 bit: one slot high, one slot data, one slot low.
+// At a 2.4 MHz pixel clock that gives 417 ns per slot.
+#define WS2812_TRANSPOSE_SLOTS_PER_BIT 3
+
+// Transpose one byte from each of 16 lanes into 8 bus words, MSB first:
+// bit l of out[b] is bit (7 - b) of in[l].
+// SWAR version: two 8x8 transposes done in 32-bit registers.
+void ws2812_transpose16(const uint8_t in[16], uint16_t out[8]);
+
+// Scalar reference for ws2812_transpose16 (same output, bit by bit)
+void ws2812_transpose16_ref(const uint8_t in[16], uint16_t out[8]);
+
+// Bytes of bus data needed for `max_lane_bytes` wire bytes per lane
+size_t ws2812_transpose_encoded_size(size_t lane_count, size_t max_lane_bytes);
+
+// Encode a whole frame for the parallel bus. lanes[l] points at lane l's
+// GRB bytes, lane_bytes[l] long; a lane stays low once it runs out of data.
+// Writes 8-bit bus words when lane_count <= 8, 16-bit words otherwise.
+// If `lut` is not NULL every byte goes through lut[byte % 3] on the way in
+// (see ws2812_correct_grb). Returns the number of bytes written to `out`.
+size_t ws2812_transpose_encode(const uint8_t *const lanes[], const uint32_t lane_bytes[],
+                               size_t lane_count, const uint8_t lut[3][256], void *out);
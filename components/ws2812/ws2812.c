@@ -1,4 +1,5 @@
 #include "ws2812.h"
+#include "ws2812_priv.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -6,258 +7,906 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_check.h"
-#include "esp_heap_caps.h"
 
-#include "driver/rmt_tx.h"
-#include "driver/rmt_encoder.h"
+#include "ws2812_port.h"
 
 static const char *TAG = "ws2812";
 
-// RMT resolution: 10 MHz (0.1us per tick)
-#define RMT_RESOLUTION_HZ 10000000
+static struct ws2812_strip s_strips[WS2812_LCD_MAX_STRIPS];
+static size_t s_strip_count = 0;
 
-// WS2812 timing (ticks)
-#define T0H 4   // 0.4us
-#define T0L 9   // 0.9us
+static const ws2812_backend_t *s_backend = NULL;
 
-#define T1H 8   // 0.8us
-#define T1L 5   // 0.5us
+// Back buffer: effects render here (GRB). The backend latches it into its
+// own front buffer on show, so rendering overlaps transmission.
+static uint8_t *s_led_buf = NULL;
+static uint32_t s_led_count = 0;
+static uint32_t s_wire_bytes = 0; // per frame, all strips (RGBW counts 4)
+
+// A frame is on the wire: set on transmit, cleared by the done interrupt
+static volatile bool s_tx_busy = false;
+
+// Optional 16-bit linear working buffer (GRB) and the per-byte dither
+// remainder. When enabled it is the source of truth and s_led_buf only
+// holds the dithered 8-bit frame handed to the backend.
+static uint16_t *s_buf16 = NULL;
+static uint8_t *s_dither_err = NULL;
+
+// 16-bit gamma curves used by the dither pass (wire order: G, R, B),
+// allocated with the 16-bit buffer and rebuilt on show after a gamma change
+static uint16_t (*s_gamma16)[WS2812_GAMMA16_POINTS] = NULL;
+static bool s_gamma16_linear = true;
+static volatile bool s_gamma16_stale = false;
+
+static ws2812_done_cb_t s_done_cb = NULL;
+static void *s_done_ctx = NULL;
+
+// Output correction. Setters only record the request; the tables are
+// rebuilt on the next show, so a brightness change never touches pixels.
+static uint8_t s_brightness = 255;     // requested
+static uint8_t s_out_brightness = 255; // after the power limiter
+static float s_gamma[3] = {1.0f, 1.0f, 1.0f}; // wire order: G, R, B
+static volatile bool s_corr_stale = false;
+// Double buffered: a caller-owned frame can still be encoding through the
+// tables in use while the next show rebuilds the other set
+static ws2812_correction_t s_corr[2] = {{.identity = true}, {.identity = true}};
+static uint8_t s_corr_front = 0;
+static const ws2812_correction_t s_corr_none = {.identity = true};
+
+// Dirty tracking: every write marks the frame dirty; show skips clean
+// frames except for a periodic keep-alive refresh.
+#define WS2812_KEEPALIVE_MS_DEFAULT 1000
+
+static volatile bool s_dirty = true;
+static bool s_dithering = false;
+static uint32_t s_keepalive_ms = WS2812_KEEPALIVE_MS_DEFAULT;
+static int64_t s_last_tx_us = 0;
+static uint32_t s_skipped_frames = 0;
+
+// Current limiter. Per-channel sums of the frame buffer in 16-bit units
+// (8-bit values count x257) are kept up to date by every writer, so the
+// check on show is O(1) instead of a pass over the frame.
+static bool s_power_on = false;
+static uint32_t s_power_budget_ma = 0;
+static ws2812_power_model_t s_power_model;
+static uint64_t s_power_sum[3]; // wire order: G, R, B
+static uint32_t s_power_ma = 0;
+
+// ------------------- FRAME BUFFER SETUP -------------------
+
+void *ws2812_frame_calloc(size_t n, size_t size)
+{
+    void *p = NULL;
 
-#define RESET_US 80
-#define RESET_TICKS (RMT_RESOLUTION_HZ / 1000000 * RESET_US)
+    if (n * size >= WS2812_PSRAM_MIN_BYTES)
+        p = heap_caps_calloc(n, size, MALLOC_CAP_SPIRAM);
+    if (!p)
+        p = heap_caps_calloc(n, size, MALLOC_CAP_INTERNAL);
 
-static rmt_channel_handle_t s_rmt_chan = NULL;
-static rmt_encoder_handle_t s_ws_encoder = NULL;
+    return p;
+}
 
-static uint8_t *s_led_buf = NULL;
-static uint32_t s_led_count = 0;
-static gpio_num_t s_gpio = -1;
+static esp_err_t ws2812_frame_alloc(const ws2812_strip_config_t *strips, size_t strip_count,
+                                    size_t max_strips)
+{
+    if (!strips || strip_count == 0 || strip_count > max_strips)
+        return ESP_ERR_INVALID_ARG;
+
+    uint32_t total = 0;
+    uint32_t wire_bytes = 0;
+
+    for (size_t i = 0; i < strip_count; i++)
+    {
+        s_strips[i].gpio = strips[i].gpio;
+        s_strips[i].offset = total;
+        s_strips[i].led_count = strips[i].led_count;
+        s_strips[i].chip = strips[i].chip;
+        total += strips[i].led_count;
+        wire_bytes += strips[i].led_count * ws2812_chip_profile(strips[i].chip)->bytes_per_led;
+    }
+
+    if (total == 0)
+        return ESP_ERR_INVALID_ARG;
+
+    s_led_buf = ws2812_frame_calloc(total, 3);
+    if (!s_led_buf)
+        return ESP_ERR_NO_MEM;
+
+    s_led_count = total;
+    s_wire_bytes = wire_bytes;
+    s_strip_count = strip_count;
+    s_dirty = true;
+
+    // The new frame is all zero; a configured power limit carries over
+    memset(s_power_sum, 0, sizeof(s_power_sum));
+    return ESP_OK;
+}
 
-// ---------------- ENCODER STRUCT ------------------
+static esp_err_t ws2812_frame_attach(esp_err_t err, const ws2812_backend_t *backend)
+{
+    if (err != ESP_OK)
+    {
+        ws2812_deinit();
+        return err;
+    }
+
+    s_backend = backend;
+    ESP_LOGI(TAG, "WS2812 initialized: backend=%s strips=%u leds=%lu max_fps=%lu",
+             backend->name, (unsigned)s_strip_count, (unsigned long)s_led_count,
+             (unsigned long)ws2812_get_max_fps());
+    return ESP_OK;
+}
 
-typedef struct {
-    rmt_encoder_t base;
-    rmt_encoder_handle_t bytes_encoder;
-    rmt_encoder_handle_t copy_encoder;
-    uint8_t state;
-} ws2812_encoder_t;
+// IRAM: the SPI master ISR may run while the flash cache is off
+bool IRAM_ATTR ws2812_frame_done_from_isr(void)
+{
+    s_tx_busy = false;
+    ws2812_stats_frame_done();
 
-enum {
-    WS_STATE_SEND_DATA = 0,
-    WS_STATE_SEND_RESET = 1
-};
+    ws2812_done_cb_t cb = s_done_cb;
+    if (!cb)
+        return false;
 
-// -------------- ENCODER API IMPLEMENTATION -------------
+    return cb(s_done_ctx);
+}
 
-static size_t ws2812_encode(
-    rmt_encoder_t *encoder,
-    rmt_channel_handle_t channel,
-    const void *primary_data,
-    size_t data_size,
-    rmt_encode_state_t *ret_state)
+// ------------------------ POWER -------------------------
+
+static inline uint32_t ws2812_value16(size_t o)
 {
-    ws2812_encoder_t *enc = __containerof(encoder, ws2812_encoder_t, base);
-    size_t encoded = 0;
-    rmt_encode_state_t state = 0;
+    return s_buf16 ? s_buf16[o] : s_led_buf[o] * 257u;
+}
 
-    if (enc->state == WS_STATE_SEND_DATA)
+// Add (or remove) the pixels in [start, start + count) to the running sums
+static void ws2812_power_span(uint32_t start, uint32_t count, bool add)
+{
+    uint64_t sum[3] = {0};
+    size_t end = (size_t)(start + count) * 3;
+
+    for (size_t o = (size_t)start * 3; o < end; o += 3)
     {
-        encoded += enc->bytes_encoder->encode(
-            enc->bytes_encoder,
-            channel,
-            primary_data,
-            data_size,
-            &state
-        );
-
-        if (state & RMT_ENCODING_COMPLETE)
-        {
-            enc->state = WS_STATE_SEND_RESET;
-        }
-        if (state & RMT_ENCODING_MEM_FULL)
-        {
-            *ret_state = state;
-            return encoded;
-        }
+        sum[0] += ws2812_value16(o);
+        sum[1] += ws2812_value16(o + 1);
+        sum[2] += ws2812_value16(o + 2);
     }
 
-    if (enc->state == WS_STATE_SEND_RESET)
+    for (int c = 0; c < 3; c++)
+        s_power_sum[c] = add ? s_power_sum[c] + sum[c] : s_power_sum[c] - sum[c];
+}
+
+static void ws2812_power_recount(void)
+{
+    memset(s_power_sum, 0, sizeof(s_power_sum));
+    if (s_led_buf)
+        ws2812_power_span(0, s_led_count, true);
+}
+
+// Highest brightness <= `brightness` that keeps the estimate in budget
+static uint8_t ws2812_power_limit(uint8_t brightness)
+{
+    if (!s_power_on)
+        return brightness;
+
+    const ws2812_power_model_t *m = &s_power_model;
+
+    // Full-scale draw of the frame as it stands, and the idle floor
+    uint64_t full_ua = (s_power_sum[0] * m->ma_green +
+                        s_power_sum[1] * m->ma_red +
+                        s_power_sum[2] * m->ma_blue) * 1000 / 65535;
+    uint64_t idle_ua = (uint64_t)s_led_count * m->idle_ua_per_led;
+    uint64_t budget_ua = (uint64_t)s_power_budget_ma * 1000;
+
+    uint8_t out = brightness;
+    if (full_ua > 0 && idle_ua + full_ua * brightness / 255 > budget_ua)
+        out = (budget_ua > idle_ua) ? (uint8_t)((budget_ua - idle_ua) * 255 / full_ua) : 0;
+
+    s_power_ma = (uint32_t)((idle_ua + full_ua * out / 255) / 1000);
+    return out;
+}
+
+// Run the limiter and return the output tables for the next frame
+static const ws2812_correction_t *ws2812_correction_update(void)
+{
+    // The limiter only ever lowers the brightness the output stage uses
+    uint8_t out_brightness = ws2812_power_limit(s_brightness);
+    if (out_brightness != s_out_brightness)
     {
-        static const rmt_symbol_word_t reset_symbol = {
-            .level0 = 0,
-            .duration0 = RESET_TICKS,
-            .level1 = 0,
-            .duration1 = 0,
-        };
-
-        state = 0;
-        encoded += enc->copy_encoder->encode(
-            enc->copy_encoder,
-            channel,
-            &reset_symbol,
-            sizeof(reset_symbol),
-            &state
-        );
-
-        if (state & RMT_ENCODING_COMPLETE) {
-            enc->state = WS_STATE_SEND_DATA;
-            *ret_state = RMT_ENCODING_COMPLETE;
-        } else if (state & RMT_ENCODING_MEM_FULL) {
-            *ret_state = RMT_ENCODING_MEM_FULL;
-        }
+        s_out_brightness = out_brightness;
+        s_corr_stale = true;
+    }
+
+    if (!s_corr_stale)
+        return &s_corr[s_corr_front];
+    s_corr_stale = false;
+
+    ws2812_correction_t *corr = &s_corr[s_corr_front ^ 1];
 
-        return encoded;
+    corr->identity = (s_out_brightness == 255 &&
+                      s_gamma[0] == 1.0f && s_gamma[1] == 1.0f && s_gamma[2] == 1.0f);
+    if (!corr->identity)
+    {
+        for (int c = 0; c < 3; c++)
+            ws2812_build_correction(corr->lut[c], s_gamma[c], s_out_brightness);
     }
 
-    *ret_state = RMT_ENCODING_COMPLETE;
-    return encoded;
+    s_corr_front ^= 1;
+    return corr;
 }
 
-static esp_err_t ws2812_reset(rmt_encoder_t *encoder)
+// Hand a frame to the backend. `external` frames are caller-owned and go
+// through transmit_external.
+static esp_err_t ws2812_backend_send(const uint8_t *frame, ws2812_pixel_fmt_t fmt, bool external,
+                                     const ws2812_correction_t *corr)
 {
-    ws2812_encoder_t *enc = __containerof(encoder, ws2812_encoder_t, base);
-    enc->state = WS_STATE_SEND_DATA;
+    s_tx_busy = true;
 
-    enc->bytes_encoder->reset(enc->bytes_encoder);
-    enc->copy_encoder->reset(enc->copy_encoder);
+    esp_err_t err = external ? s_backend->transmit_external(frame, s_led_count, fmt, corr)
+                             : s_backend->transmit(frame, s_led_count, corr);
+    if (err != ESP_OK)
+        s_tx_busy = false;
 
-    return ESP_OK;
+    return err;
 }
 
-static esp_err_t ws2812_del(rmt_encoder_t *encoder)
+// Same, timed for the stats. The wait for the previous frame is done here
+// so it can be told apart from the latch.
+static esp_err_t ws2812_transmit(const uint8_t *frame, ws2812_pixel_fmt_t fmt, bool external,
+                                 const ws2812_correction_t *corr, int64_t show_start_us)
 {
-    ws2812_encoder_t *enc = __containerof(encoder, ws2812_encoder_t, base);
+    if (!ws2812_stats_enabled())
+        return ws2812_backend_send(frame, fmt, external, corr);
 
-    if (enc->bytes_encoder)
-        enc->bytes_encoder->del(enc->bytes_encoder);
+    bool was_busy = s_tx_busy;
+    esp_err_t err = s_backend->wait_done(-1);
+    int64_t latch_start_us = esp_timer_get_time();
 
-    if (enc->copy_encoder)
-        enc->copy_encoder->del(enc->copy_encoder);
+    if (err == ESP_OK)
+        err = ws2812_backend_send(frame, fmt, external, corr);
 
-    free(enc);
+    // Unsupported external formats fall back to the frame buffer; not a failure
+    if (err != ESP_ERR_NOT_SUPPORTED)
+        ws2812_stats_record(show_start_us, latch_start_us, esp_timer_get_time(),
+                            was_busy, s_wire_bytes, err);
+    return err;
+}
 
-    return ESP_OK;
+// --------------------- PUBLIC API ------------------------
+
+esp_err_t ws2812_init(gpio_num_t gpio, uint32_t count)
+{
+    ws2812_strip_config_t cfg = {
+        .gpio = gpio,
+        .led_count = count,
+    };
+
+    return ws2812_init_strips(&cfg, 1);
 }
 
-static esp_err_t ws2812_new_encoder(rmt_encoder_handle_t *ret_encoder)
+esp_err_t ws2812_init_strips(const ws2812_strip_config_t *strips, size_t strip_count)
 {
-    ws2812_encoder_t *enc = calloc(1, sizeof(ws2812_encoder_t));
-    if (!enc)
-        return ESP_ERR_NO_MEM;
+    if (s_backend != NULL)
+        return ESP_OK;
 
-    // base API
-    enc->base.encode = ws2812_encode;
-    enc->base.reset  = ws2812_reset;
-    enc->base.del    = ws2812_del;
-    enc->state       = WS_STATE_SEND_DATA;
-
-    // bytes encoder
-    rmt_bytes_encoder_config_t bytes_cfg = {
-        .bit0 = {.duration0=T0H, .level0=1, .duration1=T0L, .level1=0},
-        .bit1 = {.duration0=T1H, .level0=1, .duration1=T1L, .level1=0},
-        .flags.msb_first = 1,
-    };
+    for (size_t i = 0; strips && i < strip_count; i++)
+    {
+        if (strips[i].led_count == 0 || (unsigned)strips[i].chip >= WS2812_CHIP_COUNT)
+            return ESP_ERR_INVALID_ARG;
+    }
 
     ESP_RETURN_ON_ERROR(
-        rmt_new_bytes_encoder(&bytes_cfg, &enc->bytes_encoder),
-        TAG, "Failed to create bytes encoder"
+        ws2812_frame_alloc(strips, strip_count, WS2812_MAX_STRIPS),
+        TAG, "Cannot allocate frame buffer"
     );
 
-    // copy encoder (for reset)
-    rmt_copy_encoder_config_t copy_cfg = {};
+    const ws2812_backend_t *backend = NULL;
+#if CONFIG_IDF_TARGET_LINUX
+    esp_err_t err = ws2812_host_init(s_strips, s_strip_count, NULL, &backend);
+#else
+    ws2812_encoder_mode_t modes[WS2812_MAX_STRIPS];
+    for (size_t i = 0; i < strip_count; i++)
+        modes[i] = strips[i].encoder;
+
+    esp_err_t err = ws2812_rmt_init(s_strips, s_strip_count, modes, &backend);
+#endif
+    return ws2812_frame_attach(err, backend);
+}
+
+esp_err_t ws2812_init_lcd(const ws2812_lcd_config_t *cfg)
+{
+    if (s_backend != NULL)
+        return ESP_OK;
+
+    if (!cfg || (cfg->strip_count != 8 && cfg->strip_count != 16))
+        return ESP_ERR_INVALID_ARG;
+
+    for (size_t i = 0; cfg->strips && i < cfg->strip_count; i++)
+    {
+        if ((unsigned)cfg->strips[i].chip >= WS2812_CHIP_COUNT)
+            return ESP_ERR_INVALID_ARG;
+    }
+
     ESP_RETURN_ON_ERROR(
-        rmt_new_copy_encoder(&copy_cfg, &enc->copy_encoder),
-        TAG, "Failed to create copy encoder"
+        ws2812_frame_alloc(cfg->strips, cfg->strip_count, WS2812_LCD_MAX_STRIPS),
+        TAG, "Cannot allocate frame buffer"
     );
 
-    *ret_encoder = &enc->base;
-    return ESP_OK;
+    const ws2812_backend_t *backend = NULL;
+#if CONFIG_IDF_TARGET_LINUX
+    esp_err_t err = ws2812_host_init(s_strips, s_strip_count, NULL, &backend);
+#else
+    esp_err_t err = ws2812_lcd_init(s_strips, s_strip_count, cfg, &backend);
+#endif
+    return ws2812_frame_attach(err, backend);
 }
 
-// --------------------- PUBLIC API ------------------------
-
-esp_err_t ws2812_init(gpio_num_t gpio, uint32_t count)
+esp_err_t ws2812_init_spi(const ws2812_spi_config_t *cfg)
 {
-    if (s_rmt_chan != NULL)
+    if (s_backend != NULL)
         return ESP_OK;
 
-    s_led_count = count;
-    s_gpio = gpio;
+    if (!cfg || cfg->led_count == 0)
+        return ESP_ERR_INVALID_ARG;
 
-    size_t buf_size = count * 3;
-    s_led_buf = heap_caps_malloc(buf_size, MALLOC_CAP_DEFAULT);
-    if (!s_led_buf)
-        return ESP_ERR_NO_MEM;
-    memset(s_led_buf, 0, buf_size);
-
-    rmt_tx_channel_config_t tx_cfg = {
-        .gpio_num = gpio,
-        .clk_src = RMT_CLK_SRC_DEFAULT,
-        .resolution_hz = RMT_RESOLUTION_HZ,
-        .mem_block_symbols = 64,
-        .trans_queue_depth = 4,
-        .flags.with_dma = true,
+    ws2812_strip_config_t strip = {
+        .gpio = cfg->data_gpio,
+        .led_count = cfg->led_count,
     };
 
     ESP_RETURN_ON_ERROR(
-        rmt_new_tx_channel(&tx_cfg, &s_rmt_chan),
-        TAG, "Cannot create RMT channel"
+        ws2812_frame_alloc(&strip, 1, 1),
+        TAG, "Cannot allocate frame buffer"
     );
 
-    ESP_RETURN_ON_ERROR(
-        ws2812_new_encoder(&s_ws_encoder),
-        TAG, "Cannot create WS2812 encoder"
-    );
+    const ws2812_backend_t *backend = NULL;
+#if CONFIG_IDF_TARGET_LINUX
+    esp_err_t err = ws2812_host_init(s_strips, s_strip_count, NULL, &backend);
+#else
+    // Header byte + BGR per LED
+    s_wire_bytes = cfg->led_count * 4;
+    esp_err_t err = ws2812_spi_init(&s_strips[0], cfg, &backend);
+#endif
+    return ws2812_frame_attach(err, backend);
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+esp_err_t ws2812_init_host(const ws2812_strip_config_t *strips, size_t strip_count,
+                           const ws2812_host_config_t *cfg)
+{
+    if (s_backend != NULL)
+        return ESP_OK;
+
+    for (size_t i = 0; strips && i < strip_count; i++)
+    {
+        if (strips[i].led_count == 0 || (unsigned)strips[i].chip >= WS2812_CHIP_COUNT)
+            return ESP_ERR_INVALID_ARG;
+    }
 
     ESP_RETURN_ON_ERROR(
-        rmt_enable(s_rmt_chan),
-        TAG, "Cannot enable RMT"
+        ws2812_frame_alloc(strips, strip_count, WS2812_LCD_MAX_STRIPS),
+        TAG, "Cannot allocate frame buffer"
     );
 
-    ESP_LOGI(TAG, "WS2812 initialized: gpio=%d leds=%lu", gpio, (unsigned long)count);
-    return ESP_OK;
+    const ws2812_backend_t *backend = NULL;
+    esp_err_t err = ws2812_host_init(s_strips, s_strip_count, cfg, &backend);
+    return ws2812_frame_attach(err, backend);
 }
+#endif
 
-esp_err_t ws2812_show(void)
+void ws2812_deinit(void)
 {
-    if (!s_rmt_chan || !s_ws_encoder)
+    if (s_backend)
+        s_backend->deinit();
+    s_backend = NULL;
+    s_tx_busy = false;
+
+    ws2812_enable_16bit(false);
+
+    heap_caps_free(s_led_buf);
+    s_led_buf = NULL;
+    s_led_count = 0;
+
+    memset(s_strips, 0, sizeof(s_strips));
+    s_strip_count = 0;
+}
+
+// True if this frame can be skipped: nothing changed, no dither pattern in
+// progress and the last refresh is recent enough
+static bool ws2812_frame_is_clean(int64_t now_us)
+{
+    if (s_dirty || s_dithering || s_keepalive_ms == 0)
+        return false;
+
+    return (now_us - s_last_tx_us) < (int64_t)s_keepalive_ms * 1000;
+}
+
+esp_err_t ws2812_show_async(void)
+{
+    if (!s_backend)
         return ESP_ERR_INVALID_STATE;
 
-    rmt_transmit_config_t tx_cfg = {
-        .loop_count = 0,
-    };
+    int64_t now_us = esp_timer_get_time();
+    if (ws2812_frame_is_clean(now_us))
+    {
+        s_skipped_frames++;
+        return ESP_OK;
+    }
 
-    ESP_RETURN_ON_ERROR(
-        rmt_transmit(s_rmt_chan, s_ws_encoder, s_led_buf, s_led_count * 3, &tx_cfg),
-        TAG, "Transmit error"
-    );
+    // Clear before latching: a write racing with the latch re-marks it
+    s_dirty = false;
+    s_last_tx_us = now_us;
+
+    const ws2812_correction_t *corr = ws2812_correction_update();
 
-    return rmt_tx_wait_all_done(s_rmt_chan, -1);
+    if (s_buf16)
+    {
+        if (s_gamma16_stale)
+        {
+            s_gamma16_stale = false;
+            s_gamma16_linear = (s_gamma[0] == 1.0f && s_gamma[1] == 1.0f && s_gamma[2] == 1.0f);
+            for (int c = 0; c < 3; c++)
+                ws2812_build_gamma16(s_gamma16[c], s_gamma[c]);
+        }
+
+        // Gamma and brightness are applied in 16 bits before dithering, so
+        // dim levels keep their fractional part; the 8-bit output is final.
+        uint16_t scale = s_out_brightness + (s_out_brightness >> 7);
+        s_dithering = ws2812_dither16(s_led_buf, s_buf16, s_dither_err, s_led_count * 3,
+                                      s_gamma16_linear ? NULL : s_gamma16, scale);
+        return ws2812_transmit(s_led_buf, WS2812_FMT_GRB, false, &s_corr_none, now_us);
+    }
+
+    return ws2812_transmit(s_led_buf, WS2812_FMT_GRB, false, corr, now_us);
+}
+
+esp_err_t ws2812_wait_done(int timeout_ms)
+{
+    if (!s_backend)
+        return ESP_ERR_INVALID_STATE;
+
+    return s_backend->wait_done(timeout_ms);
+}
+
+esp_err_t ws2812_show(void)
+{
+    ESP_RETURN_ON_ERROR(ws2812_show_async(), TAG, "Show failed");
+    return ws2812_wait_done(-1);
+}
+
+void ws2812_set_done_callback(ws2812_done_cb_t cb, void *user_ctx)
+{
+    s_done_ctx = user_ctx;
+    s_done_cb = cb;
 }
 
 void ws2812_set_pixel(uint32_t i, uint8_t r, uint8_t g, uint8_t b)
 {
     if (!s_led_buf || i >= s_led_count) return;
 
+    s_dirty = true;
+    if (s_power_on)
+        ws2812_power_span(i, 1, false);
+
     size_t o = i * 3;
-    s_led_buf[o] = g;
-    s_led_buf[o+1] = r;
-    s_led_buf[o+2] = b;
+    if (s_buf16)
+    {
+        s_buf16[o] = g * 257;
+        s_buf16[o+1] = r * 257;
+        s_buf16[o+2] = b * 257;
+    }
+    else
+    {
+        s_led_buf[o] = g;
+        s_led_buf[o+1] = r;
+        s_led_buf[o+2] = b;
+    }
+
+    if (s_power_on)
+        ws2812_power_span(i, 1, true);
+}
+
+void ws2812_set_pixel16(uint32_t i, uint16_t r, uint16_t g, uint16_t b)
+{
+    if (!s_led_buf || i >= s_led_count) return;
+
+    s_dirty = true;
+    if (s_power_on)
+        ws2812_power_span(i, 1, false);
+
+    size_t o = i * 3;
+    if (s_buf16)
+    {
+        s_buf16[o] = g;
+        s_buf16[o+1] = r;
+        s_buf16[o+2] = b;
+    }
+    else
+    {
+        s_led_buf[o] = g >> 8;
+        s_led_buf[o+1] = r >> 8;
+        s_led_buf[o+2] = b >> 8;
+    }
+
+    if (s_power_on)
+        ws2812_power_span(i, 1, true);
 }
 
 void ws2812_fill(uint8_t r, uint8_t g, uint8_t b)
 {
-    for (uint32_t i = 0; i < s_led_count; i++)
-        ws2812_set_pixel(i, r, g, b);
+    ws2812_fill_span(0, s_led_count, r, g, b);
 }
 
 void ws2812_clear(void)
 {
+    s_dirty = true;
+    memset(s_power_sum, 0, sizeof(s_power_sum));
+
     if (s_led_buf)
         memset(s_led_buf, 0, s_led_count * 3);
+    if (s_buf16)
+        memset(s_buf16, 0, s_led_count * 3 * sizeof(uint16_t));
+}
+
+// Clip [start, start + count) to the frame, mark it dirty and take the old
+// pixels out of the power sums; returns the usable length
+static inline uint32_t ws2812_span_begin(uint32_t start, uint32_t count)
+{
+    if (!s_led_buf || start >= s_led_count)
+        return 0;
+
+    s_dirty = true;
+
+    uint32_t room = s_led_count - start;
+    count = (count < room) ? count : room;
+
+    if (s_power_on)
+        ws2812_power_span(start, count, false);
+    return count;
+}
+
+// Add the freshly written span back into the power sums
+static inline void ws2812_span_end(uint32_t start, uint32_t count)
+{
+    if (s_power_on)
+        ws2812_power_span(start, count, true);
+}
+
+void ws2812_write_span(uint32_t start, const rgb_t *src, uint32_t count)
+{
+    if (!src)
+        return;
+    count = ws2812_span_begin(start, count);
+    if (count == 0)
+        return;
+
+    if (s_buf16)
+        ws2812_rgb_to_grb16(s_buf16 + start * 3, src, count);
+    else
+        ws2812_rgb_to_grb(s_led_buf + start * 3, src, count);
+
+    ws2812_span_end(start, count);
+}
+
+void ws2812_write_span_reverse(uint32_t start, const rgb_t *src, uint32_t count)
+{
+    if (!src)
+        return;
+    uint32_t kept = ws2812_span_begin(start, count);
+    if (kept == 0)
+        return;
+
+    // Clipped pixels are the ones that would land past the end
+    src += count - kept;
+
+    if (s_buf16)
+        ws2812_rgb_to_grb16_rev(s_buf16 + start * 3, src, kept);
+    else
+        ws2812_rgb_to_grb_rev(s_led_buf + start * 3, src, kept);
+
+    ws2812_span_end(start, kept);
+}
+
+void ws2812_write_span16(uint32_t start, const rgb16_t *src, uint32_t count)
+{
+    if (!src)
+        return;
+    count = ws2812_span_begin(start, count);
+    if (count == 0)
+        return;
+
+    if (s_buf16)
+    {
+        ws2812_rgb16_to_grb16(s_buf16 + start * 3, src, count);
+    }
+    else
+    {
+        uint8_t *dst = s_led_buf + start * 3;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            dst[i * 3] = src[i].g >> 8;
+            dst[i * 3 + 1] = src[i].r >> 8;
+            dst[i * 3 + 2] = src[i].b >> 8;
+        }
+    }
+
+    ws2812_span_end(start, count);
+}
+
+void ws2812_write_span16_reverse(uint32_t start, const rgb16_t *src, uint32_t count)
+{
+    if (!src)
+        return;
+    uint32_t kept = ws2812_span_begin(start, count);
+    if (kept == 0)
+        return;
+
+    src += count - kept;
+
+    if (s_buf16)
+    {
+        ws2812_rgb16_to_grb16_rev(s_buf16 + start * 3, src, kept);
+    }
+    else
+    {
+        uint8_t *dst = s_led_buf + start * 3;
+        for (uint32_t i = 0; i < kept; i++)
+        {
+            const rgb16_t *p = &src[kept - 1 - i];
+            dst[i * 3] = p->g >> 8;
+            dst[i * 3 + 1] = p->r >> 8;
+            dst[i * 3 + 2] = p->b >> 8;
+        }
+    }
+
+    ws2812_span_end(start, kept);
+}
+
+void ws2812_fill_span(uint32_t start, uint32_t count, uint8_t r, uint8_t g, uint8_t b)
+{
+    count = ws2812_span_begin(start, count);
+    if (count == 0)
+        return;
+
+    if (s_buf16)
+    {
+        rgb16_t color = {.r = r * 257, .g = g * 257, .b = b * 257};
+        ws2812_grb16_fill(s_buf16 + start * 3, color, count);
+    }
+    else
+    {
+        rgb_t color = {.r = r, .g = g, .b = b};
+        ws2812_grb_fill(s_led_buf + start * 3, color, count);
+    }
+
+    // No need to read the span back: it is all one color
+    if (s_power_on)
+    {
+        s_power_sum[0] += (uint64_t)g * 257 * count;
+        s_power_sum[1] += (uint64_t)r * 257 * count;
+        s_power_sum[2] += (uint64_t)b * 257 * count;
+    }
+}
+
+// Copy a whole packed frame into the frame buffer
+static void ws2812_frame_load(const uint8_t *frame, ws2812_pixel_fmt_t fmt)
+{
+    if (fmt == WS2812_FMT_RGB)
+    {
+        ws2812_write_span(0, (const rgb_t *)frame, s_led_count);
+        return;
+    }
+
+    uint32_t count = ws2812_span_begin(0, s_led_count);
+
+    if (s_buf16)
+    {
+        for (size_t i = 0; i < (size_t)count * 3; i++)
+            s_buf16[i] = frame[i] * 257;
+    }
+    else
+    {
+        memcpy(s_led_buf, frame, (size_t)count * 3);
+    }
+
+    ws2812_span_end(0, count);
+}
+
+esp_err_t ws2812_show_external(const uint8_t *frame, ws2812_pixel_fmt_t fmt)
+{
+    if (!s_backend)
+        return ESP_ERR_INVALID_STATE;
+
+    if (!frame || (fmt != WS2812_FMT_GRB && fmt != WS2812_FMT_RGB))
+        return ESP_ERR_INVALID_ARG;
+
+    // The current estimate only covers the frame buffer, so a limited
+    // output always goes through it
+    if (s_backend->transmit_external && !s_power_on)
+    {
+        int64_t now_us = esp_timer_get_time();
+
+        esp_err_t err = ws2812_transmit(frame, fmt, true, ws2812_correction_update(), now_us);
+        if (err != ESP_ERR_NOT_SUPPORTED)
+        {
+            // The LEDs no longer show the frame buffer; the next show must send
+            s_dirty = true;
+            s_last_tx_us = now_us;
+            return err;
+        }
+    }
+
+    ws2812_frame_load(frame, fmt);
+    return ws2812_show_async();
+}
+
+esp_err_t ws2812_enable_16bit(bool enable)
+{
+    if (!enable)
+    {
+        heap_caps_free(s_buf16);
+        heap_caps_free(s_dither_err);
+        heap_caps_free(s_gamma16);
+        s_buf16 = NULL;
+        s_dither_err = NULL;
+        s_gamma16 = NULL;
+        s_dithering = false;
+        s_dirty = true;
+
+        // s_led_buf holds the last dithered output, not the 16-bit frame
+        if (s_power_on)
+            ws2812_power_recount();
+        return ESP_OK;
+    }
+
+    if (!s_led_buf)
+        return ESP_ERR_INVALID_STATE;
+    if (s_buf16)
+        return ESP_OK;
+
+    size_t len = s_led_count * 3;
+    uint16_t *buf16 = ws2812_frame_calloc(len, sizeof(uint16_t));
+    uint8_t *err = ws2812_frame_calloc(len, 1);
+    // Read for every value on show: keep it internal
+    uint16_t (*gamma16)[WS2812_GAMMA16_POINTS] =
+        heap_caps_malloc(3 * sizeof(*gamma16), MALLOC_CAP_INTERNAL);
+    if (!buf16 || !err || !gamma16)
+    {
+        heap_caps_free(buf16);
+        heap_caps_free(err);
+        heap_caps_free(gamma16);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Carry the current 8-bit frame over
+    for (size_t i = 0; i < len; i++)
+        buf16[i] = s_led_buf[i] * 257;
+
+    s_gamma16 = gamma16;
+    s_gamma16_stale = true;
+    s_dither_err = err;
+    s_buf16 = buf16;
+    s_dirty = true;
+    return ESP_OK;
+}
+
+void ws2812_set_brightness(uint8_t brightness)
+{
+    s_brightness = brightness;
+    s_corr_stale = true;
+    s_dirty = true;
+}
+
+uint8_t ws2812_get_brightness(void)
+{
+    return s_brightness;
+}
+
+void ws2812_set_gamma(float gamma_r, float gamma_g, float gamma_b)
+{
+    s_gamma[0] = gamma_g;
+    s_gamma[1] = gamma_r;
+    s_gamma[2] = gamma_b;
+    s_corr_stale = true;
+    s_gamma16_stale = true;
+    s_dirty = true;
+}
+
+esp_err_t ws2812_set_power_limit(uint32_t budget_ma, const ws2812_power_model_t *model)
+{
+    if (budget_ma == 0)
+    {
+        s_power_on = false;
+        s_power_ma = 0;
+        s_dirty = true;
+        return ESP_OK;
+    }
+
+    if (!s_led_buf)
+        return ESP_ERR_INVALID_STATE;
+
+    static const ws2812_power_model_t default_model = {
+        .ma_red = WS2812_POWER_MA_RED,
+        .ma_green = WS2812_POWER_MA_GREEN,
+        .ma_blue = WS2812_POWER_MA_BLUE,
+        .idle_ua_per_led = WS2812_POWER_IDLE_UA,
+    };
+
+    s_power_model = model ? *model : default_model;
+    s_power_budget_ma = budget_ma;
+
+    // One full pass to seed the sums; writers keep them current from here
+    ws2812_power_recount();
+    s_power_on = true;
+    s_dirty = true;
+    return ESP_OK;
+}
+
+uint32_t ws2812_get_power_ma(void)
+{
+    return s_power_ma;
+}
+
+void ws2812_set_keepalive_ms(uint32_t period_ms)
+{
+    s_keepalive_ms = period_ms;
+}
+
+uint32_t ws2812_get_skipped_frames(void)
+{
+    return s_skipped_frames;
 }
 
 uint32_t ws2812_get_count(void)
 {
     return s_led_count;
 }
+
+size_t ws2812_get_strip_count(void)
+{
+    return s_strip_count;
+}
+
+ws2812_strip_handle_t ws2812_get_strip(size_t index)
+{
+    return (index < s_strip_count) ? &s_strips[index] : NULL;
+}
+
+uint32_t ws2812_strip_get_offset(ws2812_strip_handle_t strip)
+{
+    return strip ? strip->offset : 0;
+}
+
+uint32_t ws2812_strip_get_count(ws2812_strip_handle_t strip)
+{
+    return strip ? strip->led_count : 0;
+}
+
+gpio_num_t ws2812_strip_get_gpio(ws2812_strip_handle_t strip)
+{
+    return strip ? strip->gpio : GPIO_NUM_NC;
+}
+
+ws2812_chip_t ws2812_strip_get_chip(ws2812_strip_handle_t strip)
+{
+    return strip ? strip->chip : WS2812_CHIP_WS2812B;
+}
+
+uint32_t ws2812_get_max_fps(void)
+{
+    if (!s_backend)
+        return 0;
+
+    uint32_t frame_us = s_backend->frame_us();
+    return frame_us ? 1000000 / frame_us : 0;
+}
+
+esp_err_t ws2812_get_isr_stats(size_t strip_index, ws2812_isr_stats_t *out)
+{
+    if (!out)
+        return ESP_ERR_INVALID_ARG;
+    if (!s_backend)
+        return ESP_ERR_INVALID_STATE;
+    if (!s_backend->get_isr_stats)
+        return ESP_ERR_NOT_SUPPORTED;
+
+    return s_backend->get_isr_stats(strip_index, out);
+}
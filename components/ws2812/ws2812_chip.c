@@ -0,0 +1,73 @@
+#include "ws2812_chip.h"
+
+#include <string.h>
+
+// Datasheet windows the values below sit in:
+//   WS2812B       T0H 400 T1H 800 T0L 850 T1L 450 (+-150), latch > 50 us.
+//                 V5 parts want 280 us; use the WS2813 profile for those.
+//   WS2812C-2020  T0H 220-380 T1H 580-1600 T0L 580-1600 T1L 220-420, latch > 280 us
+//   WS2813        T0H 220-380 T1H 580-1000 T0L 580-1000 T1L 580-1000, latch > 280 us
+//   SK6812        T0H 300 T1H 600 T0L 900 T1L 600 (+-150), latch > 80 us
+static const ws2812_chip_profile_t s_profiles[WS2812_CHIP_COUNT] = {
+    [WS2812_CHIP_WS2812B] = {
+        .name = "ws2812b",
+        .t0h_ns = 400, .t0l_ns = 900, .t1h_ns = 800, .t1l_ns = 500,
+        .reset_us = 80, .bytes_per_led = 3,
+    },
+    [WS2812_CHIP_WS2812C_2020] = {
+        .name = "ws2812c-2020",
+        .t0h_ns = 300, .t0l_ns = 700, .t1h_ns = 700, .t1l_ns = 300,
+        .reset_us = 280, .bytes_per_led = 3,
+    },
+    [WS2812_CHIP_WS2813] = {
+        .name = "ws2813",
+        .t0h_ns = 300, .t0l_ns = 700, .t1h_ns = 700, .t1l_ns = 600,
+        .reset_us = 280, .bytes_per_led = 3,
+    },
+    [WS2812_CHIP_SK6812] = {
+        .name = "sk6812",
+        .t0h_ns = 300, .t0l_ns = 800, .t1h_ns = 600, .t1l_ns = 500,
+        .reset_us = 80, .bytes_per_led = 3,
+    },
+    [WS2812_CHIP_SK6812_RGBW] = {
+        .name = "sk6812-rgbw",
+        .t0h_ns = 300, .t0l_ns = 800, .t1h_ns = 600, .t1l_ns = 500,
+        .reset_us = 80, .bytes_per_led = 4,
+    },
+};
+
+const ws2812_chip_profile_t *ws2812_chip_profile(ws2812_chip_t chip)
+{
+    if ((unsigned)chip >= WS2812_CHIP_COUNT)
+        chip = WS2812_CHIP_WS2812B;
+
+    return &s_profiles[chip];
+}
+
+ws2812_chip_t ws2812_chip_from_name(const char *name)
+{
+    for (int c = 0; name && c < WS2812_CHIP_COUNT; c++)
+    {
+        if (strcmp(name, s_profiles[c].name) == 0)
+            return (ws2812_chip_t)c;
+    }
+
+    return WS2812_CHIP_COUNT;
+}
+
+uint32_t ws2812_chip_frame_us(ws2812_chip_t chip, uint32_t led_count)
+{
+    const ws2812_chip_profile_t *p = ws2812_chip_profile(chip);
+
+    uint32_t bit0_ns = p->t0h_ns + p->t0l_ns;
+    uint32_t bit1_ns = p->t1h_ns + p->t1l_ns;
+    uint64_t bits = (uint64_t)led_count * p->bytes_per_led * 8;
+
+    uint64_t data_ns = bits * (bit1_ns > bit0_ns ? bit1_ns : bit0_ns);
+    return (uint32_t)((data_ns + 999) / 1000) + p->reset_us;
+}
+
+uint32_t ws2812_chip_max_fps(ws2812_chip_t chip, uint32_t led_count)
+{
+    return 1000000 / ws2812_chip_frame_us(chip, led_count);
+}
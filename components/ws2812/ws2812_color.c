@@ -0,0 +1,273 @@
+#include "ws2812_color.h"
+
+#include <string.h>
+#include <math.h>
+
+// Little-endian word layout is assumed (ESP32-S3 and build hosts):
+// byte 0 of a buffer is the low byte of the loaded word.
+
+static inline uint32_t load32(const void *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store32(void *p, uint32_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+void ws2812_rgb_to_grb(uint8_t *dst, const rgb_t *src, size_t count)
+{
+    const uint8_t *s = (const uint8_t *)src;
+    size_t i = 0;
+
+    // in:  R0 G0 B0 R1 | G1 B1 R2 G2 | B2 R3 G3 B3
+    // out: G0 R0 B0 G1 | R1 B1 G2 R2 | B2 G3 R3 B3
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32_t w0 = load32(s), w1 = load32(s + 4), w2 = load32(s + 8);
+
+        uint32_t o0 = ((w0 >> 8) & 0x000000FF) | ((w0 << 8) & 0x0000FF00) |
+                      (w0 & 0x00FF0000) | (w1 << 24);
+        uint32_t o1 = (w0 >> 24) | (w1 & 0x0000FF00) |
+                      ((w1 >> 8) & 0x00FF0000) | ((w1 << 8) & 0xFF000000);
+        uint32_t o2 = (w2 & 0xFF0000FF) | ((w2 >> 8) & 0x0000FF00) |
+                      ((w2 << 8) & 0x00FF0000);
+
+        store32(dst, o0);
+        store32(dst + 4, o1);
+        store32(dst + 8, o2);
+
+        s += 12;
+        dst += 12;
+    }
+
+    for (; i < count; i++)
+    {
+        dst[0] = s[1];
+        dst[1] = s[0];
+        dst[2] = s[2];
+        s += 3;
+        dst += 3;
+    }
+}
+
+void ws2812_rgb_to_grb_ref(uint8_t *dst, const rgb_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i * 3] = src[i].g;
+        dst[i * 3 + 1] = src[i].r;
+        dst[i * 3 + 2] = src[i].b;
+    }
+}
+
+void ws2812_rgb_to_grb_rev(uint8_t *dst, const rgb_t *src, size_t count)
+{
+    const rgb_t *s = src + count;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        s--;
+        dst[0] = s->g;
+        dst[1] = s->r;
+        dst[2] = s->b;
+        dst += 3;
+    }
+}
+
+void ws2812_grb_fill(uint8_t *dst, rgb_t color, size_t count)
+{
+    const uint8_t px[3] = {color.g, color.r, color.b};
+    uint8_t pattern[12];
+    size_t i = 0;
+
+    for (int k = 0; k < 12; k++)
+        pattern[k] = px[k % 3];
+
+    for (; i + 4 <= count; i += 4)
+    {
+        memcpy(dst, pattern, sizeof(pattern));
+        dst += sizeof(pattern);
+    }
+
+    for (; i < count; i++)
+    {
+        memcpy(dst, px, sizeof(px));
+        dst += 3;
+    }
+}
+
+void ws2812_build_correction(uint8_t table[256], float gamma, uint8_t brightness)
+{
+    for (int v = 0; v < 256; v++)
+    {
+        float lin = (gamma == 1.0f) ? v / 255.0f : powf(v / 255.0f, gamma);
+        table[v] = (uint8_t)(lin * brightness + 0.5f);
+    }
+}
+
+void ws2812_correct_grb(uint8_t *dst, const uint8_t *src, size_t len,
+                        const uint8_t lut[3][256])
+{
+    for (size_t i = 0; i < len; i += 3)
+    {
+        dst[i] = lut[0][src[i]];
+        dst[i + 1] = lut[1][src[i + 1]];
+        dst[i + 2] = lut[2][src[i + 2]];
+    }
+}
+
+void ws2812_pixels_to_wire(uint8_t *dst, const uint8_t *src, size_t count,
+                           ws2812_pixel_fmt_t fmt, const uint8_t lut[3][256],
+                           uint8_t bytes_per_led)
+{
+    // Source offsets of the G and R bytes; B is last in both formats
+    const size_t gi = (fmt == WS2812_FMT_RGB) ? 1 : 0;
+    const size_t ri = (fmt == WS2812_FMT_RGB) ? 0 : 1;
+
+    for (size_t i = 0; i < count; i++, src += 3, dst += bytes_per_led)
+    {
+        uint8_t g = lut ? lut[0][src[gi]] : src[gi];
+        uint8_t r = lut ? lut[1][src[ri]] : src[ri];
+        uint8_t b = lut ? lut[2][src[2]] : src[2];
+
+        if (bytes_per_led == 4)
+        {
+            uint8_t w = g < r ? g : r;
+            w = b < w ? b : w;
+
+            g -= w;
+            r -= w;
+            b -= w;
+            dst[3] = w;
+        }
+
+        dst[0] = g;
+        dst[1] = r;
+        dst[2] = b;
+    }
+}
+
+void ws2812_rgb16_to_grb16(uint16_t *dst, const rgb16_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i * 3] = src[i].g;
+        dst[i * 3 + 1] = src[i].r;
+        dst[i * 3 + 2] = src[i].b;
+    }
+}
+
+void ws2812_rgb16_to_grb16_rev(uint16_t *dst, const rgb16_t *src, size_t count)
+{
+    const rgb16_t *s = src + count;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        s--;
+        dst[0] = s->g;
+        dst[1] = s->r;
+        dst[2] = s->b;
+        dst += 3;
+    }
+}
+
+void ws2812_rgb_to_grb16(uint16_t *dst, const rgb_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i * 3] = src[i].g * 257;
+        dst[i * 3 + 1] = src[i].r * 257;
+        dst[i * 3 + 2] = src[i].b * 257;
+    }
+}
+
+void ws2812_rgb_to_grb16_rev(uint16_t *dst, const rgb_t *src, size_t count)
+{
+    const rgb_t *s = src + count;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        s--;
+        dst[0] = s->g * 257;
+        dst[1] = s->r * 257;
+        dst[2] = s->b * 257;
+        dst += 3;
+    }
+}
+
+void ws2812_grb16_fill(uint16_t *dst, rgb16_t color, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i * 3] = color.g;
+        dst[i * 3 + 1] = color.r;
+        dst[i * 3 + 2] = color.b;
+    }
+}
+
+void ws2812_build_gamma16(uint16_t table[WS2812_GAMMA16_POINTS], float gamma)
+{
+    for (int k = 0; k < WS2812_GAMMA16_POINTS; k++)
+    {
+        float x = k / 256.0f;
+        float lin = (gamma == 1.0f || k == 256) ? x : powf(x, gamma);
+        float out = lin * 65535.0f + 0.5f;
+        table[k] = (uint16_t)(out > 65535.0f ? 65535.0f : out);
+    }
+}
+
+// Value on a 16-bit gamma curve, interpolated between its two points
+static inline uint32_t ws2812_gamma16(const uint16_t *t, uint32_t v)
+{
+    uint32_t k = v >> 8;
+    int32_t a = t[k];
+    int32_t b = t[k + 1];
+
+    return (uint32_t)(a + (((b - a) * (int32_t)(v & 0xFF)) >> 8));
+}
+
+// Scale one value into 8.8 output steps (k from ws2812_dither16), add the
+// carried fraction and truncate; returns the fraction of the scaled value.
+// The result stays below 0xFFFF, so it never overflows.
+static inline uint32_t ws2812_dither_one(uint8_t *dst, uint8_t *err, uint32_t v, uint32_t k)
+{
+    uint32_t s = (v * k) >> 16;
+    uint32_t o = s + *err;
+
+    *dst = (uint8_t)(o >> 8);
+    *err = (uint8_t)o;
+    return s & 0xFF;
+}
+
+bool ws2812_dither16(uint8_t *dst, const uint16_t *src, uint8_t *err, size_t len,
+                     const uint16_t lut[3][WS2812_GAMMA16_POINTS], uint16_t scale)
+{
+    uint32_t frac = 0;
+
+    // 16-bit value -> 8.8 output steps: v * scale / 257 (65535 is 255.0),
+    // as a Q16 factor rounded up. Rounding up keeps v = L * 257 at exactly
+    // L * 256 with no fraction, so widened 8-bit frames do not dither.
+    const uint32_t k = ((uint32_t)scale * 65536 + 256) / 257;
+
+    if (!lut)
+    {
+        for (size_t i = 0; i < len; i++)
+            frac |= ws2812_dither_one(&dst[i], &err[i], src[i], k);
+        return frac != 0;
+    }
+
+    for (size_t i = 0; i < len; i += 3)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            uint32_t v = ws2812_gamma16(lut[c], src[i + c]);
+            frac |= ws2812_dither_one(&dst[i + c], &err[i + c], v, k);
+        }
+    }
+
+    return frac != 0;
+}
@@ -0,0 +1,276 @@
+#include "ws2812_priv.h"
+#include "ws2812_host.h"
+#include "ws2812_port.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+static const char *TAG = "ws2812_host";
+
+static const struct ws2812_strip *s_strips = NULL;
+static size_t s_strip_count = 0;
+static bool s_realtime = false;
+
+// Wire bytes of one frame (all strips) and where each strip starts
+static uint32_t s_wire_bytes = 0;
+static uint32_t s_wire_offset[WS2812_LCD_MAX_STRIPS];
+
+// Ring of sent frames, newest at s_ring_head
+typedef struct
+{
+    int64_t start_us;
+    uint32_t wire_us;
+    uint32_t seq;
+} ws2812_host_slot_t;
+
+static uint8_t *s_ring = NULL;
+static ws2812_host_slot_t *s_slots = NULL;
+static size_t s_ring_frames = 0;
+static size_t s_ring_head = 0;
+static uint32_t s_frame_count = 0;
+
+static FILE *s_capture = NULL;
+
+// Simulated wire: the last frame is on the line until s_wire_end_us
+static int64_t s_wire_end_us = 0;
+static bool s_done_pending = false;
+
+static void ws2812_host_sleep_until(int64_t t_us)
+{
+    int64_t now_us;
+    while ((now_us = esp_timer_get_time()) < t_us)
+    {
+        struct timespec ts = {
+            .tv_sec = (t_us - now_us) / 1000000,
+            .tv_nsec = ((t_us - now_us) % 1000000) * 1000,
+        };
+        // Interrupted sleeps (the POSIX FreeRTOS tick) just go round again
+        nanosleep(&ts, NULL);
+    }
+}
+
+// Report the frame in flight once its simulated wire time is over
+static void ws2812_host_complete(void)
+{
+    if (!s_done_pending)
+        return;
+
+    s_done_pending = false;
+    ws2812_frame_done_from_isr();
+}
+
+static esp_err_t ws2812_host_wait_done(int timeout_ms)
+{
+    if (s_realtime)
+    {
+        int64_t now_us = esp_timer_get_time();
+        if (timeout_ms >= 0 && s_wire_end_us - now_us > (int64_t)timeout_ms * 1000)
+        {
+            ws2812_host_sleep_until(now_us + (int64_t)timeout_ms * 1000);
+            return ESP_ERR_TIMEOUT;
+        }
+
+        ws2812_host_sleep_until(s_wire_end_us);
+    }
+
+    ws2812_host_complete();
+    return ESP_OK;
+}
+
+static uint32_t ws2812_host_frame_us(void)
+{
+    // Strips start together, so the slowest one sets the frame time
+    uint32_t frame_us = 0;
+    for (size_t i = 0; i < s_strip_count; i++)
+    {
+        uint32_t us = ws2812_chip_frame_us(s_strips[i].chip, s_strips[i].led_count);
+        if (us > frame_us)
+            frame_us = us;
+    }
+
+    return frame_us;
+}
+
+static esp_err_t ws2812_host_send(const uint8_t *frame, ws2812_pixel_fmt_t fmt,
+                                  const ws2812_correction_t *corr)
+{
+    ws2812_host_wait_done(-1);
+
+    const uint8_t (*map)[256] = corr->identity ? NULL : corr->lut;
+    ws2812_host_slot_t *slot = &s_slots[s_ring_head];
+    uint8_t *wire = s_ring + s_ring_head * s_wire_bytes;
+
+    for (size_t i = 0; i < s_strip_count; i++)
+    {
+        const struct ws2812_strip *strip = &s_strips[i];
+        ws2812_pixels_to_wire(wire + s_wire_offset[i], frame + strip->offset * 3,
+                              strip->led_count, fmt, map,
+                              ws2812_chip_profile(strip->chip)->bytes_per_led);
+    }
+
+    // Back to back if show is called faster than the wire can go
+    int64_t now_us = esp_timer_get_time();
+    slot->start_us = (now_us > s_wire_end_us) ? now_us : s_wire_end_us;
+    slot->wire_us = ws2812_host_frame_us();
+    slot->seq = s_frame_count++;
+    s_wire_end_us = slot->start_us + slot->wire_us;
+
+    if (s_capture)
+    {
+        fwrite(&slot->start_us, sizeof(slot->start_us), 1, s_capture);
+        fwrite(&slot->wire_us, sizeof(slot->wire_us), 1, s_capture);
+        fwrite(&s_wire_bytes, sizeof(s_wire_bytes), 1, s_capture);
+        if (fwrite(wire, 1, s_wire_bytes, s_capture) != s_wire_bytes)
+            ESP_LOGW(TAG, "Capture write failed (frame %lu)", (unsigned long)slot->seq);
+    }
+
+    s_ring_head = (s_ring_head + 1) % s_ring_frames;
+    s_done_pending = true;
+
+    // At full speed the frame is out as soon as it is recorded
+    if (!s_realtime)
+        ws2812_host_complete();
+
+    return ESP_OK;
+}
+
+static esp_err_t ws2812_host_transmit(const uint8_t *frame, uint32_t led_count,
+                                      const ws2812_correction_t *corr)
+{
+    return ws2812_host_send(frame, WS2812_FMT_GRB, corr);
+}
+
+static esp_err_t ws2812_host_transmit_external(const uint8_t *frame, uint32_t led_count,
+                                               ws2812_pixel_fmt_t fmt,
+                                               const ws2812_correction_t *corr)
+{
+    return ws2812_host_send(frame, fmt, corr);
+}
+
+static void ws2812_host_deinit(void)
+{
+    ws2812_host_wait_done(-1);
+
+    if (s_capture)
+        fclose(s_capture);
+    s_capture = NULL;
+
+    heap_caps_free(s_ring);
+    heap_caps_free(s_slots);
+    s_ring = NULL;
+    s_slots = NULL;
+    s_ring_frames = 0;
+    s_ring_head = 0;
+    s_frame_count = 0;
+    s_wire_bytes = 0;
+    s_wire_end_us = 0;
+    s_done_pending = false;
+    s_strips = NULL;
+    s_strip_count = 0;
+}
+
+static esp_err_t ws2812_host_capture_open(const char *path)
+{
+    s_capture = fopen(path, "wb");
+    ESP_RETURN_ON_FALSE(s_capture, ESP_FAIL, TAG, "Cannot open %s: %s", path, strerror(errno));
+
+    uint16_t version = WS2812_HOST_CAPTURE_VERSION;
+    uint16_t strip_count = s_strip_count;
+
+    fwrite(WS2812_HOST_CAPTURE_MAGIC, 1, 4, s_capture);
+    fwrite(&version, sizeof(version), 1, s_capture);
+    fwrite(&strip_count, sizeof(strip_count), 1, s_capture);
+
+    for (size_t i = 0; i < s_strip_count; i++)
+    {
+        uint32_t led_count = s_strips[i].led_count;
+        uint8_t desc[4] = {ws2812_chip_profile(s_strips[i].chip)->bytes_per_led,
+                           (uint8_t)s_strips[i].chip, 0, 0};
+
+        fwrite(&led_count, sizeof(led_count), 1, s_capture);
+        fwrite(desc, 1, sizeof(desc), s_capture);
+    }
+
+    return ESP_OK;
+}
+
+static const ws2812_backend_t s_host_backend = {
+    .name = "host",
+    .transmit = ws2812_host_transmit,
+    .transmit_external = ws2812_host_transmit_external,
+    .wait_done = ws2812_host_wait_done,
+    .deinit = ws2812_host_deinit,
+    .frame_us = ws2812_host_frame_us,
+};
+
+esp_err_t ws2812_host_init(const struct ws2812_strip *strips, size_t strip_count,
+                           const ws2812_host_config_t *cfg,
+                           const ws2812_backend_t **out_backend)
+{
+    esp_err_t ret = ESP_OK;
+
+    s_strips = strips;
+    s_strip_count = strip_count;
+    s_realtime = cfg ? cfg->realtime : false;
+
+    s_wire_bytes = 0;
+    for (size_t i = 0; i < strip_count; i++)
+    {
+        s_wire_offset[i] = s_wire_bytes;
+        s_wire_bytes += strips[i].led_count * ws2812_chip_profile(strips[i].chip)->bytes_per_led;
+    }
+
+    s_ring_frames = cfg ? cfg->ring_frames : WS2812_HOST_RING_FRAMES_DEFAULT;
+    if (s_ring_frames == 0)
+        s_ring_frames = 1;
+
+    s_ring = heap_caps_calloc(s_ring_frames, s_wire_bytes, MALLOC_CAP_DEFAULT);
+    s_slots = heap_caps_calloc(s_ring_frames, sizeof(*s_slots), MALLOC_CAP_DEFAULT);
+    ESP_GOTO_ON_FALSE(s_ring && s_slots, ESP_ERR_NO_MEM, err, TAG, "No memory for %u frame ring",
+                      (unsigned)s_ring_frames);
+
+    if (cfg && cfg->capture_path)
+    {
+        ESP_GOTO_ON_ERROR(ws2812_host_capture_open(cfg->capture_path), err, TAG, "No capture file");
+    }
+
+    ESP_LOGI(TAG, "host backend: %u strips, %lu wire bytes/frame, ring=%u%s%s",
+             (unsigned)strip_count, (unsigned long)s_wire_bytes, (unsigned)s_ring_frames,
+             s_capture ? ", capture=" : "", s_capture ? cfg->capture_path : "");
+
+    *out_backend = &s_host_backend;
+    return ESP_OK;
+
+err:
+    ws2812_host_deinit();
+    return ret;
+}
+
+esp_err_t ws2812_host_get_frame(size_t age, ws2812_host_frame_t *out)
+{
+    if (!out)
+        return ESP_ERR_INVALID_ARG;
+
+    if (!s_ring || age >= s_ring_frames || age >= s_frame_count)
+        return ESP_ERR_NOT_FOUND;
+
+    size_t idx = (s_ring_head + s_ring_frames - 1 - age) % s_ring_frames;
+
+    out->wire = s_ring + idx * s_wire_bytes;
+    out->wire_bytes = s_wire_bytes;
+    out->start_us = s_slots[idx].start_us;
+    out->wire_us = s_slots[idx].wire_us;
+    out->seq = s_slots[idx].seq;
+    return ESP_OK;
+}
+
+uint32_t ws2812_host_get_frame_count(void)
+{
+    return s_frame_count;
+}
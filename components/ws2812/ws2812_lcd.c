@@ -0,0 +1,235 @@
+#include "ws2812_priv.h"
+#include "ws2812_transpose.h"
+
+#include <string.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "soc/soc_caps.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#if SOC_LCD_I80_SUPPORTED
+#include "esp_lcd_panel_io.h"
+
+static const char *TAG = "ws2812_lcd";
+
+// 3 bus slots per WS2812 bit at 2.4 MHz: 417 ns high + data + low
+#define LCD_PCLK_HZ 2400000
+
+// Bit time is fixed by the bus clock (1.25 us, which every supported chip
+// accepts); the latch after the data follows the slowest chip profile
+#define LCD_SLOTS_PER_US (LCD_PCLK_HZ / 1000000)
+
+static esp_lcd_i80_bus_handle_t s_bus = NULL;
+static esp_lcd_panel_io_handle_t s_io = NULL;
+static SemaphoreHandle_t s_done_sem = NULL;
+static volatile bool s_busy = false;
+
+static const struct ws2812_strip *s_strips = NULL;
+static size_t s_strip_count = 0;
+
+// DMA buffer holding the transposed frame followed by the latch slots
+static uint8_t *s_dma_buf = NULL;
+static size_t s_dma_size = 0;
+static size_t s_data_size = 0;
+static uint32_t s_frame_us = 0;
+
+static bool ws2812_lcd_on_done(esp_lcd_panel_io_handle_t io,
+                               esp_lcd_panel_io_event_data_t *edata,
+                               void *user_ctx)
+{
+    BaseType_t woken = pdFALSE;
+
+    s_busy = false;
+    xSemaphoreGiveFromISR(s_done_sem, &woken);
+
+    return ws2812_frame_done_from_isr() || woken == pdTRUE;
+}
+
+static esp_err_t ws2812_lcd_wait_done(int timeout_ms)
+{
+    if (!s_busy)
+        return ESP_OK;
+
+    TickType_t ticks = (timeout_ms < 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    if (xSemaphoreTake(s_done_sem, ticks) != pdTRUE)
+        return ESP_ERR_TIMEOUT;
+
+    return ESP_OK;
+}
+
+static esp_err_t ws2812_lcd_transmit(const uint8_t *frame, uint32_t led_count,
+                                     const ws2812_correction_t *corr)
+{
+    ESP_RETURN_ON_ERROR(
+        ws2812_lcd_wait_done(-1),
+        TAG, "Wait for previous frame failed"
+    );
+
+    // The latch is the bit transpose: each strip is one lane of the bus
+    const uint8_t *lanes[WS2812_LCD_MAX_STRIPS];
+    uint32_t lane_bytes[WS2812_LCD_MAX_STRIPS];
+
+    for (size_t i = 0; i < s_strip_count; i++)
+    {
+        lanes[i] = frame + s_strips[i].offset * 3;
+        lane_bytes[i] = s_strips[i].led_count * 3;
+    }
+
+    ws2812_transpose_encode(lanes, lane_bytes, s_strip_count,
+                            corr->identity ? NULL : corr->lut, s_dma_buf);
+
+    // Drain a stale give left by a frame nobody waited for
+    xSemaphoreTake(s_done_sem, 0);
+    s_busy = true;
+
+    esp_err_t err = esp_lcd_panel_io_tx_color(s_io, -1, s_dma_buf, s_dma_size);
+    if (err != ESP_OK)
+        s_busy = false;
+
+    return err;
+}
+
+// The transpose reads the lanes in place, so GRB frames need no copy
+static esp_err_t ws2812_lcd_transmit_external(const uint8_t *frame, uint32_t led_count,
+                                              ws2812_pixel_fmt_t fmt,
+                                              const ws2812_correction_t *corr)
+{
+    if (fmt != WS2812_FMT_GRB)
+        return ESP_ERR_NOT_SUPPORTED;
+
+    return ws2812_lcd_transmit(frame, led_count, corr);
+}
+
+static void ws2812_lcd_deinit(void)
+{
+    if (s_io)
+    {
+        ws2812_lcd_wait_done(-1);
+        esp_lcd_panel_io_del(s_io);
+    }
+    if (s_bus)
+        esp_lcd_del_i80_bus(s_bus);
+    if (s_done_sem)
+        vSemaphoreDelete(s_done_sem);
+
+    heap_caps_free(s_dma_buf);
+
+    s_io = NULL;
+    s_bus = NULL;
+    s_done_sem = NULL;
+    s_dma_buf = NULL;
+    s_dma_size = 0;
+    s_data_size = 0;
+    s_frame_us = 0;
+    s_busy = false;
+    s_strips = NULL;
+    s_strip_count = 0;
+}
+
+static uint32_t ws2812_lcd_frame_us(void)
+{
+    return s_frame_us;
+}
+
+static const ws2812_backend_t s_lcd_backend = {
+    .name = "lcd",
+    .transmit = ws2812_lcd_transmit,
+    .transmit_external = ws2812_lcd_transmit_external,
+    .wait_done = ws2812_lcd_wait_done,
+    .deinit = ws2812_lcd_deinit,
+    .frame_us = ws2812_lcd_frame_us,
+};
+
+esp_err_t ws2812_lcd_init(const struct ws2812_strip *strips, size_t strip_count,
+                          const ws2812_lcd_config_t *cfg,
+                          const ws2812_backend_t **out_backend)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t max_leds = 0;
+    uint32_t reset_us = 0;
+
+    for (size_t i = 0; i < strip_count; i++)
+    {
+        const ws2812_chip_profile_t *chip = ws2812_chip_profile(strips[i].chip);
+
+        // The transpose works on 3-byte pixels in every lane
+        ESP_RETURN_ON_FALSE(chip->bytes_per_led == 3, ESP_ERR_NOT_SUPPORTED, TAG,
+                            "Strip %u: %s is not supported on the parallel bus", (unsigned)i, chip->name);
+
+        if (strips[i].led_count > max_leds)
+            max_leds = strips[i].led_count;
+        if (chip->reset_us > reset_us)
+            reset_us = chip->reset_us;
+    }
+
+    s_strips = strips;
+    s_strip_count = strip_count;
+
+    size_t word_size = (strip_count <= 8) ? 1 : 2;
+    s_data_size = ws2812_transpose_encoded_size(strip_count, max_leds * 3);
+    s_dma_size = s_data_size + reset_us * LCD_SLOTS_PER_US * word_size;
+    s_frame_us = (uint32_t)((uint64_t)(s_dma_size / word_size) * 1000000 / LCD_PCLK_HZ);
+
+    // Latch slots after the data are zero and never rewritten
+    s_dma_buf = heap_caps_calloc(1, s_dma_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    ESP_GOTO_ON_FALSE(s_dma_buf, ESP_ERR_NO_MEM, err, TAG, "No memory for %u byte DMA buffer", (unsigned)s_dma_size);
+
+    s_done_sem = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(s_done_sem, ESP_ERR_NO_MEM, err, TAG, "No memory for semaphore");
+
+    esp_lcd_i80_bus_config_t bus_cfg = {
+        .dc_gpio_num = cfg->dc_gpio,
+        .wr_gpio_num = cfg->wr_gpio,
+        .clk_src = LCD_CLK_SRC_DEFAULT,
+        .bus_width = strip_count,
+        .max_transfer_bytes = s_dma_size,
+        .psram_trans_align = 64,
+        .sram_trans_align = 4,
+    };
+    for (size_t i = 0; i < strip_count; i++)
+        bus_cfg.data_gpio_nums[i] = strips[i].gpio;
+
+    ESP_GOTO_ON_ERROR(esp_lcd_new_i80_bus(&bus_cfg, &s_bus), err, TAG, "Cannot create i80 bus");
+
+    esp_lcd_panel_io_i80_config_t io_cfg = {
+        .cs_gpio_num = -1,
+        .pclk_hz = LCD_PCLK_HZ,
+        .trans_queue_depth = 2,
+        .on_color_trans_done = ws2812_lcd_on_done,
+        .lcd_cmd_bits = 0,
+        .lcd_param_bits = 0,
+        .dc_levels = {
+            .dc_idle_level = 0,
+            .dc_cmd_level = 0,
+            .dc_dummy_level = 0,
+            .dc_data_level = 1,
+        },
+    };
+
+    ESP_GOTO_ON_ERROR(esp_lcd_new_panel_io_i80(s_bus, &io_cfg, &s_io), err, TAG, "Cannot create i80 panel IO");
+
+    ESP_LOGI(TAG, "LCD bus: %u lanes, %u byte frame", (unsigned)strip_count, (unsigned)s_dma_size);
+
+    *out_backend = &s_lcd_backend;
+    return ESP_OK;
+
+err:
+    ws2812_lcd_deinit();
+    return ret;
+}
+
+#else
+
+esp_err_t ws2812_lcd_init(const struct ws2812_strip *strips, size_t strip_count,
+                          const ws2812_lcd_config_t *cfg,
+                          const ws2812_backend_t **out_backend)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // SOC_LCD_I80_SUPPORTED
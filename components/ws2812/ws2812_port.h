@@ -0,0 +1,60 @@
+#pragma once
+
+// Platform glue for the frame buffer core, so ws2812.c also builds for the
+// linux target (host backend). On the chip this is just the IDF headers.
+
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+// One flat heap on the host; capability flags are accepted and ignored
+#define MALLOC_CAP_DEFAULT  0
+#define MALLOC_CAP_INTERNAL 0
+#define MALLOC_CAP_DMA      0
+#define MALLOC_CAP_SPIRAM   0
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    (void)caps;
+    return calloc(n, size);
+}
+
+static inline void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+static inline bool esp_ptr_external_ram(const void *p)
+{
+    (void)p;
+    return false;
+}
+
+#define IRAM_ATTR
+
+static inline int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+#else
+
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "esp_timer.h"
+
+#endif // CONFIG_IDF_TARGET_LINUX
@@ -0,0 +1,101 @@
+#pragma once
+
+// Internal interface between the ws2812 frame buffer (ws2812.c) and the
+// output backends that put it on the wire (RMT, LCD_CAM, ...).
+
+#include "ws2812.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include "ws2812_host.h"
+#endif
+
+// Strip instance. Strips sit back to back in the frame buffer, so a pixel
+// index is the strip offset plus the local index.
+struct ws2812_strip
+{
+    gpio_num_t gpio;
+    uint32_t offset;
+    uint32_t led_count;
+    ws2812_chip_t chip;
+};
+
+// Gamma + brightness, applied by the backend in the same pass that latches
+// the frame into its wire buffer. lut[c] maps byte c of each GRB triplet.
+// When `identity` is set the tables are a no-op and a plain copy will do.
+// The tables handed to a backend stay untouched until the next transmit.
+typedef struct
+{
+    bool identity;
+    uint8_t lut[3][256];
+} ws2812_correction_t;
+
+typedef struct
+{
+    const char *name;
+
+    // Wait for the previous frame, latch `frame` (led_count * 3 GRB bytes)
+    // through `corr` into the backend's wire buffer and start sending it.
+    // Must not block on the new frame.
+    esp_err_t (*transmit)(const uint8_t *frame, uint32_t led_count,
+                          const ws2812_correction_t *corr);
+
+    // Optional: start sending a caller-owned frame (led_count packed 3-byte
+    // pixels in `fmt` order) without latching it into the frame buffer. The
+    // frame and `corr` stay in use until the transfer completes. Returns
+    // ESP_ERR_NOT_SUPPORTED if this backend cannot handle `fmt`.
+    esp_err_t (*transmit_external)(const uint8_t *frame, uint32_t led_count,
+                                   ws2812_pixel_fmt_t fmt, const ws2812_correction_t *corr);
+
+    // Wait until the frame started by transmit() is fully on the wire
+    esp_err_t (*wait_done)(int timeout_ms);
+
+    // Stop output and free every backend resource
+    void (*deinit)(void);
+
+    // Wire time of one full frame including the latch, in microseconds
+    uint32_t (*frame_us)(void);
+
+    // Optional: interrupt load of one strip
+    esp_err_t (*get_isr_stats)(size_t strip_index, ws2812_isr_stats_t *out);
+} ws2812_backend_t;
+
+// Backend constructors. `strips` stays valid until deinit.
+esp_err_t ws2812_rmt_init(const struct ws2812_strip *strips, size_t strip_count,
+                          const ws2812_encoder_mode_t *modes,
+                          const ws2812_backend_t **out_backend);
+
+esp_err_t ws2812_lcd_init(const struct ws2812_strip *strips, size_t strip_count,
+                          const ws2812_lcd_config_t *cfg,
+                          const ws2812_backend_t **out_backend);
+
+esp_err_t ws2812_spi_init(const struct ws2812_strip *strip, const ws2812_spi_config_t *cfg,
+                          const ws2812_backend_t **out_backend);
+
+#if CONFIG_IDF_TARGET_LINUX
+esp_err_t ws2812_host_init(const struct ws2812_strip *strips, size_t strip_count,
+                           const ws2812_host_config_t *cfg,
+                           const ws2812_backend_t **out_backend);
+#endif
+
+// Per-LED buffers (frame buffers, front buffers) of at least this size are
+// placed in PSRAM when the chip has it, so long installations do not eat
+// the internal heap. Smaller ones stay internal, where access is fastest.
+#ifndef WS2812_PSRAM_MIN_BYTES
+#define WS2812_PSRAM_MIN_BYTES 4096
+#endif
+
+// Zeroed per-LED buffer, PSRAM first for large sizes, internal RAM as the
+// fallback. Free with heap_caps_free().
+void *ws2812_frame_calloc(size_t n, size_t size);
+
+// Called by a backend (ISR context) once the whole frame has been sent.
+// Returns true if a higher priority task was woken.
+bool ws2812_frame_done_from_isr(void);
+
+// Transmit statistics (ws2812_stats.c), fed by the core for every frame it
+// hands to the backend. Timestamps are esp_timer microseconds: show entry,
+// end of the wait for the previous frame, and return from the backend.
+bool ws2812_stats_enabled(void);
+void ws2812_stats_record(int64_t show_start_us, int64_t latch_start_us, int64_t end_us,
+                         bool was_busy, uint32_t wire_bytes, esp_err_t err);
+void ws2812_stats_frame_done(void);
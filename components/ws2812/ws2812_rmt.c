@@ -0,0 +1,993 @@
+#include "ws2812_priv.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "driver/rmt_tx.h"
+#include "driver/rmt_encoder.h"
+#include "soc/soc_caps.h"
+
+static const char *TAG = "ws2812_rmt";
+
+// RMT resolution: 10 MHz (0.1us per tick). Bit and latch timing come
+// from each strip's chip profile.
+#define RMT_RESOLUTION_HZ 10000000
+#define RMT_TICK_NS (1000000000 / RMT_RESOLUTION_HZ)
+#define RMT_TICKS_PER_US (RMT_RESOLUTION_HZ / 1000000)
+
+// DMA ping-pong buffer for a channel fed from pre-expanded symbols. Each
+// refill is a plain copy, so a bigger block just means fewer interrupts.
+#define DMA_BLOCK_SYMBOLS_LUT 1024
+
+// Symbols per wire byte (one per bit)
+#define SYMBOLS_PER_BYTE 8
+
+// Frames the ISR should not read directly (a front buffer in PSRAM,
+// caller-owned frames in PSRAM or flash, or ones that still need
+// converting) are streamed through a ring of internal RAM chunks of this
+// many pixels. A chunk is about 1.9 ms of wire time at 3 bytes per LED, so
+// the ring gives the feeder task several milliseconds of slack.
+#define BOUNCE_PIXELS 64
+#define BOUNCE_BYTES (BOUNCE_PIXELS * 4)
+#define BOUNCE_SLOTS 4
+
+// Refills the chunk rings. Above the render task, so a refill is never
+// held up by rendering the next frame.
+#define FEEDER_STACK_SIZE 2048
+#define FEEDER_PRIORITY (configMAX_PRIORITIES - 2)
+
+// One RMT TX channel per strip
+typedef struct
+{
+    rmt_channel_handle_t chan;
+    rmt_encoder_handle_t encoder;
+    ws2812_encoder_mode_t mode;
+    const ws2812_chip_profile_t *chip;
+
+    // This strip's wire bytes in the front buffer
+    uint32_t wire_offset;
+
+    // WS2812_ENCODER_LUT: frame pre-expanded to RMT symbols on latch
+    rmt_symbol_word_t *symbols;
+    const rmt_symbol_word_t *lut;
+
+    // RMT memory blocks of a channel without DMA, see ws2812_rmt_plan_blocks()
+    uint8_t mem_blocks;
+
+    // Encoder runs: the first fill plus one per refill interrupt
+    uint32_t encode_calls;
+    ws2812_isr_stats_t stats;
+} ws2812_rmt_chan_t;
+
+static const struct ws2812_strip *s_strips = NULL;
+static ws2812_rmt_chan_t s_chans[WS2812_MAX_STRIPS];
+static size_t s_strip_count = 0;
+static rmt_sync_manager_handle_t s_sync = NULL;
+
+// Front buffer: owned by the RMT while a frame is in flight. In PSRAM for
+// long installations, in which case it is streamed through the chunk rings.
+static uint8_t *s_tx_buf = NULL;
+static bool s_tx_buf_psram = false;
+
+static TaskHandle_t s_feeder = NULL;
+static SemaphoreHandle_t s_feeder_stopped = NULL;
+static volatile bool s_feeder_running = false;
+
+static uint32_t s_strips_pending = 0;
+
+// Byte -> 8 symbol lookup tables, one per chip timing, shared by all
+// WS2812_ENCODER_LUT channels driving that chip
+static rmt_symbol_word_t *s_luts[WS2812_CHIP_COUNT];
+
+// ---------------- ENCODER STRUCT ------------------
+
+typedef struct {
+    rmt_encoder_t base;
+    rmt_encoder_handle_t bytes_encoder;
+    rmt_encoder_handle_t copy_encoder;
+    uint8_t state;
+    bool prebuilt;          // primary data is already RMT symbols
+    rmt_symbol_word_t reset_symbol;
+
+    // Staged frames: chunk k of `src` is converted (or copied) into slot
+    // k % BOUNCE_SLOTS by show or the feeder task, and the ISR only feeds
+    // ready slots to the bytes encoder. `lock` guards the counters and
+    // `ready`; the source fields only change while nothing is staged.
+    bool staged;
+    bool convert;        // swizzle and correct, else copy wire bytes
+    const uint8_t *src;
+    uint32_t pixels;
+    uint32_t chunks;
+    ws2812_pixel_fmt_t fmt;
+    const uint8_t (*map)[256];
+    uint8_t bytes_per_led;
+
+    portMUX_TYPE lock;
+    uint32_t gen;        // bumped per frame, drops late results
+    uint32_t claimed;    // chunks handed to a producer
+    uint32_t consumed;   // chunks fully encoded (ISR only)
+    uint32_t producing;  // conversions in progress
+    uint32_t ready[BOUNCE_SLOTS]; // k + 1 once chunk k sits in its slot
+    uint16_t slot_len[BOUNCE_SLOTS];
+    uint8_t slots[BOUNCE_SLOTS][BOUNCE_BYTES];
+
+    // Chunk being encoded; `rescue` holds one the feeder was late with
+    const uint8_t *cur;
+    uint16_t cur_len;
+    uint8_t rescue[BOUNCE_BYTES];
+
+    uint32_t *call_counter;
+    uint32_t *underruns;
+} ws2812_encoder_t;
+
+enum {
+    WS_STATE_SEND_DATA = 0,
+    WS_STATE_SEND_RESET = 1
+};
+
+// -------------- ENCODER API IMPLEMENTATION -------------
+
+// Chunk k of the staged frame as wire bytes into dst; returns the length.
+// Only reads the frame, so show, the feeder and the ISR may all call it.
+static uint16_t ws2812_chunk_convert(const ws2812_encoder_t *enc, uint32_t k, uint8_t *dst)
+{
+    uint32_t first = k * BOUNCE_PIXELS;
+    uint32_t count = enc->pixels - first < BOUNCE_PIXELS ? enc->pixels - first : BOUNCE_PIXELS;
+
+    if (enc->convert)
+        ws2812_pixels_to_wire(dst, enc->src + first * 3, count,
+                              enc->fmt, enc->map, enc->bytes_per_led);
+    else
+        memcpy(dst, enc->src + first * enc->bytes_per_led, count * enc->bytes_per_led);
+
+    return count * enc->bytes_per_led;
+}
+
+// Fill every free slot of the ring. Runs in task context: from show for
+// the first slots, then from the feeder each time the ISR frees one.
+static void ws2812_ring_produce(ws2812_encoder_t *enc)
+{
+    for (;;)
+    {
+        uint32_t k = 0, gen = 0;
+
+        taskENTER_CRITICAL(&enc->lock);
+        bool take = enc->staged && enc->claimed < enc->chunks &&
+                    enc->claimed - enc->consumed < BOUNCE_SLOTS;
+        if (take)
+        {
+            k = enc->claimed++;
+            gen = enc->gen;
+            enc->producing++;
+        }
+        taskEXIT_CRITICAL(&enc->lock);
+
+        if (!take)
+            return;
+
+        uint32_t slot = k % BOUNCE_SLOTS;
+        uint16_t len = ws2812_chunk_convert(enc, k, enc->slots[slot]);
+
+        taskENTER_CRITICAL(&enc->lock);
+        if (enc->gen == gen)
+        {
+            enc->slot_len[slot] = len;
+            enc->ready[slot] = k + 1;
+        }
+        enc->producing--;
+        taskEXIT_CRITICAL(&enc->lock);
+    }
+}
+
+// Next chunk for the ISR. If the feeder has not finished it, the ISR
+// converts it itself into `rescue` rather than stall the wire, and counts
+// an underrun.
+static void ws2812_ring_take(ws2812_encoder_t *enc)
+{
+    uint32_t k = enc->consumed;
+    uint32_t slot = k % BOUNCE_SLOTS;
+
+    portENTER_CRITICAL_SAFE(&enc->lock);
+    bool ready = (enc->ready[slot] == k + 1);
+    if (!ready && enc->claimed == k)
+        enc->claimed++;
+    portEXIT_CRITICAL_SAFE(&enc->lock);
+
+    if (ready)
+    {
+        enc->cur = enc->slots[slot];
+        enc->cur_len = enc->slot_len[slot];
+        return;
+    }
+
+    enc->cur = enc->rescue;
+    enc->cur_len = ws2812_chunk_convert(enc, k, enc->rescue);
+    (*enc->underruns)++;
+}
+
+// A chunk is out: free its slot and wake the feeder. The first fill runs
+// from rmt_transmit() in task context; show wakes the feeder after that.
+static void ws2812_ring_release(ws2812_encoder_t *enc)
+{
+    portENTER_CRITICAL_SAFE(&enc->lock);
+    enc->consumed++;
+    portEXIT_CRITICAL_SAFE(&enc->lock);
+    enc->cur_len = 0;
+
+    if (s_feeder && xPortInIsrContext())
+    {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(s_feeder, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+// Data stage for staged frames. Returns with *state holding
+// RMT_ENCODING_COMPLETE once the whole frame is out, or
+// RMT_ENCODING_MEM_FULL when the RMT memory filled up part way through.
+static size_t ws2812_encode_staged(ws2812_encoder_t *enc, rmt_channel_handle_t channel,
+                                   rmt_encode_state_t *state)
+{
+    rmt_encoder_handle_t bytes_encoder = enc->bytes_encoder;
+    size_t encoded = 0;
+
+    while (enc->cur_len || enc->consumed < enc->chunks)
+    {
+        if (!enc->cur_len)
+            ws2812_ring_take(enc);
+
+        rmt_encode_state_t chunk_state = 0;
+        encoded += bytes_encoder->encode(bytes_encoder, channel, enc->cur,
+                                         enc->cur_len, &chunk_state);
+
+        if (chunk_state & RMT_ENCODING_COMPLETE)
+            ws2812_ring_release(enc);
+        if (chunk_state & RMT_ENCODING_MEM_FULL)
+        {
+            *state = RMT_ENCODING_MEM_FULL;
+            return encoded;
+        }
+    }
+
+    *state = RMT_ENCODING_COMPLETE;
+    return encoded;
+}
+
+static size_t ws2812_encode(
+    rmt_encoder_t *encoder,
+    rmt_channel_handle_t channel,
+    const void *primary_data,
+    size_t data_size,
+    rmt_encode_state_t *ret_state)
+{
+    ws2812_encoder_t *enc = __containerof(encoder, ws2812_encoder_t, base);
+    size_t encoded = 0;
+    rmt_encode_state_t state = 0;
+
+    (*enc->call_counter)++;
+
+    if (enc->state == WS_STATE_SEND_DATA)
+    {
+        if (enc->staged)
+        {
+            encoded += ws2812_encode_staged(enc, channel, &state);
+        }
+        else
+        {
+            // Pre-expanded frames only need copying into RMT memory
+            rmt_encoder_handle_t data_encoder = enc->prebuilt ? enc->copy_encoder : enc->bytes_encoder;
+
+            encoded += data_encoder->encode(
+                data_encoder,
+                channel,
+                primary_data,
+                data_size,
+                &state
+            );
+        }
+
+        if (state & RMT_ENCODING_COMPLETE)
+        {
+            enc->state = WS_STATE_SEND_RESET;
+        }
+        if (state & RMT_ENCODING_MEM_FULL)
+        {
+            *ret_state = state;
+            return encoded;
+        }
+    }
+
+    if (enc->state == WS_STATE_SEND_RESET)
+    {
+        state = 0;
+        encoded += enc->copy_encoder->encode(
+            enc->copy_encoder,
+            channel,
+            &enc->reset_symbol,
+            sizeof(enc->reset_symbol),
+            &state
+        );
+
+        if (state & RMT_ENCODING_COMPLETE) {
+            enc->state = WS_STATE_SEND_DATA;
+            *ret_state = RMT_ENCODING_COMPLETE;
+        } else if (state & RMT_ENCODING_MEM_FULL) {
+            *ret_state = RMT_ENCODING_MEM_FULL;
+        }
+
+        return encoded;
+    }
+
+    *ret_state = RMT_ENCODING_COMPLETE;
+    return encoded;
+}
+
+static esp_err_t ws2812_reset(rmt_encoder_t *encoder)
+{
+    ws2812_encoder_t *enc = __containerof(encoder, ws2812_encoder_t, base);
+    enc->state = WS_STATE_SEND_DATA;
+    enc->cur_len = 0;
+
+    enc->bytes_encoder->reset(enc->bytes_encoder);
+    enc->copy_encoder->reset(enc->copy_encoder);
+
+    return ESP_OK;
+}
+
+static esp_err_t ws2812_del(rmt_encoder_t *encoder)
+{
+    ws2812_encoder_t *enc = __containerof(encoder, ws2812_encoder_t, base);
+
+    if (enc->bytes_encoder)
+        enc->bytes_encoder->del(enc->bytes_encoder);
+
+    if (enc->copy_encoder)
+        enc->copy_encoder->del(enc->copy_encoder);
+
+    heap_caps_free(enc);
+
+    return ESP_OK;
+}
+
+// Nearest whole tick, never zero
+static inline uint16_t ws2812_ns_to_ticks(uint16_t ns)
+{
+    uint16_t ticks = (ns + RMT_TICK_NS / 2) / RMT_TICK_NS;
+    return ticks ? ticks : 1;
+}
+
+static void ws2812_bit_symbols(const ws2812_chip_profile_t *chip,
+                               rmt_symbol_word_t *bit0, rmt_symbol_word_t *bit1)
+{
+    *bit0 = (rmt_symbol_word_t){
+        .duration0 = ws2812_ns_to_ticks(chip->t0h_ns), .level0 = 1,
+        .duration1 = ws2812_ns_to_ticks(chip->t0l_ns), .level1 = 0,
+    };
+    *bit1 = (rmt_symbol_word_t){
+        .duration0 = ws2812_ns_to_ticks(chip->t1h_ns), .level0 = 1,
+        .duration1 = ws2812_ns_to_ticks(chip->t1l_ns), .level1 = 0,
+    };
+}
+
+static esp_err_t ws2812_new_encoder(bool prebuilt, const ws2812_chip_profile_t *chip,
+                                    ws2812_rmt_chan_t *ch, rmt_encoder_handle_t *ret_encoder)
+{
+    // Internal RAM: the encoder state and chunk ring are used by the RMT ISR
+    ws2812_encoder_t *enc = heap_caps_calloc(1, sizeof(ws2812_encoder_t), MALLOC_CAP_INTERNAL);
+    if (!enc)
+        return ESP_ERR_NO_MEM;
+
+    enc->prebuilt = prebuilt;
+    enc->call_counter = &ch->encode_calls;
+    enc->underruns = &ch->stats.bounce_underruns;
+    portMUX_INITIALIZE(&enc->lock);
+
+    // base API
+    enc->base.encode = ws2812_encode;
+    enc->base.reset  = ws2812_reset;
+    enc->base.del    = ws2812_del;
+    enc->state       = WS_STATE_SEND_DATA;
+
+    enc->reset_symbol = (rmt_symbol_word_t){
+        .level0 = 0,
+        .duration0 = chip->reset_us * RMT_TICKS_PER_US,
+        .level1 = 0,
+        .duration1 = 0,
+    };
+
+    // bytes encoder
+    rmt_bytes_encoder_config_t bytes_cfg = {
+        .flags.msb_first = 1,
+    };
+    ws2812_bit_symbols(chip, &bytes_cfg.bit0, &bytes_cfg.bit1);
+
+    ESP_RETURN_ON_ERROR(
+        rmt_new_bytes_encoder(&bytes_cfg, &enc->bytes_encoder),
+        TAG, "Failed to create bytes encoder"
+    );
+
+    // copy encoder (for reset)
+    rmt_copy_encoder_config_t copy_cfg = {};
+    ESP_RETURN_ON_ERROR(
+        rmt_new_copy_encoder(&copy_cfg, &enc->copy_encoder),
+        TAG, "Failed to create copy encoder"
+    );
+
+    *ret_encoder = &enc->base;
+    return ESP_OK;
+}
+
+// Choose how the next frame's data is encoded. Only call while the
+// channel is idle. A staged frame gets its first slots filled here, so
+// the ISR starts on internal RAM.
+static void ws2812_encoder_set_source(rmt_encoder_handle_t encoder, bool staged, bool convert,
+                                      const uint8_t *src, uint32_t pixels,
+                                      ws2812_pixel_fmt_t fmt, const uint8_t map[3][256],
+                                      uint8_t bytes_per_led)
+{
+    ws2812_encoder_t *enc = __containerof(encoder, ws2812_encoder_t, base);
+
+    // Stop new claims on the last frame, then let a conversion the ISR
+    // already rescued run out before its source fields change
+    taskENTER_CRITICAL(&enc->lock);
+    enc->staged = false;
+    enc->gen++;
+    taskEXIT_CRITICAL(&enc->lock);
+
+    for (;;)
+    {
+        taskENTER_CRITICAL(&enc->lock);
+        bool idle = (enc->producing == 0);
+        taskEXIT_CRITICAL(&enc->lock);
+        if (idle)
+            break;
+        taskYIELD();
+    }
+
+    enc->convert = convert;
+    enc->src = src;
+    enc->pixels = pixels;
+    enc->chunks = (pixels + BOUNCE_PIXELS - 1) / BOUNCE_PIXELS;
+    enc->fmt = fmt;
+    enc->map = map;
+    enc->bytes_per_led = bytes_per_led;
+
+    taskENTER_CRITICAL(&enc->lock);
+    enc->claimed = 0;
+    enc->consumed = 0;
+    memset(enc->ready, 0, sizeof(enc->ready));
+    enc->staged = staged;
+    taskEXIT_CRITICAL(&enc->lock);
+
+    if (staged)
+        ws2812_ring_produce(enc);
+}
+
+// ----------------- CHUNK FEEDER TASK ---------------------
+
+static void ws2812_feeder_task(void *arg)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!s_feeder_running)
+            break;
+
+        for (size_t i = 0; i < s_strip_count; i++)
+            ws2812_ring_produce(__containerof(s_chans[i].encoder, ws2812_encoder_t, base));
+    }
+
+    xSemaphoreGive(s_feeder_stopped);
+    vTaskDelete(NULL);
+}
+
+static void ws2812_feeder_stop(void)
+{
+    if (s_feeder)
+    {
+        s_feeder_running = false;
+        xTaskNotifyGive(s_feeder);
+        xSemaphoreTake(s_feeder_stopped, portMAX_DELAY);
+        s_feeder = NULL;
+    }
+
+    if (s_feeder_stopped)
+    {
+        vSemaphoreDelete(s_feeder_stopped);
+        s_feeder_stopped = NULL;
+    }
+}
+
+// ------------------ SYMBOL LOOKUP TABLE ------------------
+
+static const rmt_symbol_word_t *ws2812_lut_build(ws2812_chip_t chip)
+{
+    if (s_luts[chip])
+        return s_luts[chip];
+
+    rmt_symbol_word_t *lut = heap_caps_malloc(256 * SYMBOLS_PER_BYTE * sizeof(rmt_symbol_word_t),
+                                              MALLOC_CAP_INTERNAL);
+    if (!lut)
+        return NULL;
+
+    rmt_symbol_word_t bit0, bit1;
+    ws2812_bit_symbols(ws2812_chip_profile(chip), &bit0, &bit1);
+
+    for (int v = 0; v < 256; v++)
+    {
+        for (int b = 0; b < SYMBOLS_PER_BYTE; b++)
+            lut[v * SYMBOLS_PER_BYTE + b] = (v & (0x80 >> b)) ? bit1 : bit0;
+    }
+
+    s_luts[chip] = lut;
+    return lut;
+}
+
+// Bulk pass on the render core: one table copy per byte, with the output
+// correction (map, may be NULL) folded into the table index
+static void ws2812_lut_expand(rmt_symbol_word_t *dst, const uint8_t *src, size_t len,
+                              const uint8_t map[3][256], const rmt_symbol_word_t *lut)
+{
+    const size_t sym_bytes = SYMBOLS_PER_BYTE * sizeof(*dst);
+
+    if (!map)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            memcpy(dst, &lut[src[i] * SYMBOLS_PER_BYTE], sym_bytes);
+            dst += SYMBOLS_PER_BYTE;
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < len; i += 3)
+    {
+        memcpy(dst, &lut[map[0][src[i]] * SYMBOLS_PER_BYTE], sym_bytes);
+        memcpy(dst + SYMBOLS_PER_BYTE, &lut[map[1][src[i + 1]] * SYMBOLS_PER_BYTE], sym_bytes);
+        memcpy(dst + 2 * SYMBOLS_PER_BYTE, &lut[map[2][src[i + 2]] * SYMBOLS_PER_BYTE], sym_bytes);
+        dst += 3 * SYMBOLS_PER_BYTE;
+    }
+}
+
+// ----------------- TX DONE CALLBACK ---------------------
+
+static bool ws2812_on_trans_done(
+    rmt_channel_handle_t channel,
+    const rmt_tx_done_event_data_t *edata,
+    void *user_ctx)
+{
+    ws2812_rmt_chan_t *ch = user_ctx;
+
+    ch->stats.encoder_calls = ch->encode_calls;
+    if (ch->encode_calls > ch->stats.encoder_calls_max)
+        ch->stats.encoder_calls_max = ch->encode_calls;
+    ch->stats.frames++;
+    ch->encode_calls = 0;
+
+    // Report the frame once the last (longest) strip has finished
+    if (__atomic_sub_fetch(&s_strips_pending, 1, __ATOMIC_ACQ_REL) != 0)
+        return false;
+
+    return ws2812_frame_done_from_isr();
+}
+
+// Share the RMT memory between the channels without DMA. The DMA channel
+// always sits on the last TX channel, and a channel can only take on the
+// blocks of the channels after it, so the others split the blocks in front
+// of it: one each, spare ones to LUT channels, where a refill is a plain
+// copy and a bigger block directly means fewer interrupts. Most refills
+// first. On the S3 that is 3 blocks of 48 symbols: a LUT strip next to the
+// DMA strip gets all three, but with 3 or 4 strips nothing is spare. A LUT
+// channel left with one block would take as many refills as bytes mode for
+// 96 B/LED of internal RAM, so it is switched to bytes mode.
+static void ws2812_rmt_plan_blocks(const struct ws2812_strip *strips, size_t strip_count,
+                                   size_t dma_index)
+{
+    int spare = (SOC_RMT_TX_CANDIDATES_PER_GROUP - 1) - (int)(strip_count - 1);
+
+    for (size_t i = 0; i < strip_count; i++)
+        s_chans[i].mem_blocks = 1;
+
+    for (; spare > 0; spare--)
+    {
+        size_t best = strip_count;
+        uint32_t best_load = 0;
+
+        for (size_t i = 0; i < strip_count; i++)
+        {
+            if (i == dma_index || s_chans[i].mode != WS2812_ENCODER_LUT)
+                continue;
+
+            // Wire bytes per block, i.e. refills per frame
+            uint32_t load = strips[i].led_count * s_chans[i].chip->bytes_per_led /
+                            s_chans[i].mem_blocks;
+            if (best == strip_count || load > best_load)
+            {
+                best = i;
+                best_load = load;
+            }
+        }
+
+        if (best == strip_count)
+            break;
+        s_chans[best].mem_blocks++;
+    }
+
+    for (size_t i = 0; i < strip_count; i++)
+    {
+        if (i != dma_index && s_chans[i].mode == WS2812_ENCODER_LUT && s_chans[i].mem_blocks == 1)
+        {
+            ESP_LOGW(TAG, "strip %u: no spare RMT memory for LUT mode, using bytes", (unsigned)i);
+            s_chans[i].mode = WS2812_ENCODER_BYTES;
+        }
+    }
+}
+
+static esp_err_t ws2812_chan_setup(const struct ws2812_strip *strip, ws2812_rmt_chan_t *ch,
+                                   bool with_dma)
+{
+    if (ch->mode == WS2812_ENCODER_LUT)
+    {
+        ch->lut = ws2812_lut_build(strip->chip);
+        ESP_RETURN_ON_FALSE(ch->lut, ESP_ERR_NO_MEM, TAG, "No memory for symbol LUT");
+
+        // Read by the CPU (copy encoder, in the ISR), never by DMA: plain
+        // internal RAM, leaving DMA-capable memory to the drivers. Never
+        // PSRAM, which would stall the ISR on every refill; if it does not
+        // fit, the strip runs in bytes mode instead.
+        size_t bytes = strip->led_count * ch->chip->bytes_per_led * SYMBOLS_PER_BYTE *
+                       sizeof(rmt_symbol_word_t);
+        ch->symbols = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL);
+        if (!ch->symbols)
+        {
+            ESP_LOGW(TAG, "No internal RAM for %u byte symbol buffer (gpio=%d), using bytes mode",
+                     (unsigned)bytes, strip->gpio);
+            ch->mode = WS2812_ENCODER_BYTES;
+        }
+    }
+
+    bool prebuilt = (ch->mode == WS2812_ENCODER_LUT);
+
+    // Only one TX channel can own the DMA; the rest stream from the RMT
+    // memory blocks planned for them.
+    size_t dma_symbols = prebuilt ? DMA_BLOCK_SYMBOLS_LUT : 64;
+
+    rmt_tx_channel_config_t tx_cfg = {
+        .gpio_num = strip->gpio,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = RMT_RESOLUTION_HZ,
+        .mem_block_symbols = with_dma ? dma_symbols : ch->mem_blocks * SOC_RMT_MEM_WORDS_PER_CHANNEL,
+        .trans_queue_depth = 4,
+        .flags.with_dma = with_dma,
+    };
+
+    ESP_RETURN_ON_ERROR(
+        rmt_new_tx_channel(&tx_cfg, &ch->chan),
+        TAG, "Cannot create RMT channel (gpio=%d)", strip->gpio
+    );
+
+    ESP_RETURN_ON_ERROR(
+        ws2812_new_encoder(prebuilt, ch->chip, ch, &ch->encoder),
+        TAG, "Cannot create WS2812 encoder"
+    );
+
+    rmt_tx_event_callbacks_t cbs = {
+        .on_trans_done = ws2812_on_trans_done,
+    };
+    ESP_RETURN_ON_ERROR(
+        rmt_tx_register_event_callbacks(ch->chan, &cbs, ch),
+        TAG, "Cannot register TX callback"
+    );
+
+    return ESP_OK;
+}
+
+// -------------------- BACKEND OPS ------------------------
+
+static esp_err_t ws2812_rmt_wait_done(int timeout_ms)
+{
+    for (size_t i = 0; i < s_strip_count; i++)
+    {
+        ESP_RETURN_ON_ERROR(
+            rmt_tx_wait_all_done(s_chans[i].chan, timeout_ms),
+            TAG, "Wait for strip %u failed", (unsigned)i
+        );
+    }
+
+    return ESP_OK;
+}
+
+// Strip `failed` could not be queued, so the frame will not go out. The
+// strips after it never will be, and with a sync manager the ones queued
+// before it are held waiting for it: disabling a channel drops its queued
+// transaction, so they are aborted and the next show does not wait on them.
+// Without a sync manager there is a single strip and nothing was queued.
+static void ws2812_rmt_abort(size_t failed)
+{
+    if (s_sync)
+    {
+        for (size_t i = 0; i < failed; i++)
+        {
+            rmt_disable(s_chans[i].chan);
+            rmt_enable(s_chans[i].chan);
+        }
+    }
+
+    __atomic_store_n(&s_strips_pending, 0, __ATOMIC_RELEASE);
+}
+
+// Start one frame on every strip. Frame buffer frames are latched into the
+// front buffer; `external` (caller-owned) frames are encoded in place
+// wherever the channel allows it. The ISR only ever reads internal RAM:
+// anything else, or anything still to be converted, is staged.
+static esp_err_t ws2812_rmt_send(const uint8_t *frame, ws2812_pixel_fmt_t fmt, bool external,
+                                 const ws2812_correction_t *corr)
+{
+    // The front buffer still belongs to the RMT until the previous frame is
+    // out. When rendering takes longer than the wire time this returns at once.
+    ESP_RETURN_ON_ERROR(
+        ws2812_rmt_wait_done(-1),
+        TAG, "Wait for previous frame failed"
+    );
+
+    if (s_sync)
+    {
+        ESP_RETURN_ON_ERROR(rmt_sync_reset(s_sync), TAG, "Sync reset failed");
+    }
+
+    rmt_transmit_config_t tx_cfg = {
+        .loop_count = 0,
+    };
+
+    __atomic_store_n(&s_strips_pending, s_strip_count, __ATOMIC_RELEASE);
+
+    for (size_t i = 0; i < s_strip_count; i++)
+    {
+        const struct ws2812_strip *strip = &s_strips[i];
+        ws2812_rmt_chan_t *ch = &s_chans[i];
+        const uint8_t *src = frame + strip->offset * 3;
+        uint8_t *wire = s_tx_buf + ch->wire_offset;
+        uint8_t bytes_per_led = ch->chip->bytes_per_led;
+        size_t len = strip->led_count * bytes_per_led;
+        const uint8_t (*map)[256] = corr->identity ? NULL : corr->lut;
+
+        const void *payload;
+        size_t payload_size;
+        bool staged = false;
+        bool stage_convert = false;
+
+        // Frames that are not plain GRB (RGB order, RGBW chips) become wire
+        // bytes first, with the correction folded in
+        bool convert = (fmt != WS2812_FMT_GRB || bytes_per_led != 3);
+
+        if (external && ch->mode == WS2812_ENCODER_BYTES)
+        {
+            // Zero copy: a wire-ready frame in internal RAM goes straight
+            // to the bytes encoder, anything else is converted or copied
+            // chunk by chunk through the ring on the way
+            stage_convert = (convert || map);
+            staged = stage_convert || !esp_ptr_internal(src);
+            payload = src;
+            payload_size = stage_convert ? strip->led_count * 3 : len;
+        }
+        else
+        {
+            // Latch into this strip's front buffer. The back buffer keeps
+            // its contents, so callers that only touch a few pixels per
+            // frame still work.
+            if (convert)
+            {
+                ws2812_pixels_to_wire(wire, src, strip->led_count, fmt, map, bytes_per_led);
+                src = wire;
+                map = NULL;
+            }
+
+            if (ch->mode == WS2812_ENCODER_LUT)
+            {
+                ws2812_lut_expand(ch->symbols, src, len, map, ch->lut);
+                payload = ch->symbols;
+                payload_size = len * SYMBOLS_PER_BYTE * sizeof(rmt_symbol_word_t);
+            }
+            else
+            {
+                if (map)
+                    ws2812_correct_grb(wire, src, len, map);
+                else if (src != wire)
+                    memcpy(wire, src, len);
+                payload = wire;
+                payload_size = len;
+                staged = s_tx_buf_psram;
+            }
+        }
+
+        ws2812_encoder_set_source(ch->encoder, staged, stage_convert, payload, strip->led_count,
+                                  fmt, map, bytes_per_led);
+
+        esp_err_t err = rmt_transmit(ch->chan, ch->encoder, payload, payload_size, &tx_cfg);
+        if (err != ESP_OK)
+        {
+            ws2812_rmt_abort(i);
+            ESP_LOGE(TAG, "Transmit error on strip %u: %s", (unsigned)i, esp_err_to_name(err));
+            return err;
+        }
+    }
+
+    // Refill the slots the first fills have used
+    xTaskNotifyGive(s_feeder);
+    return ESP_OK;
+}
+
+static esp_err_t ws2812_rmt_transmit(const uint8_t *frame, uint32_t led_count,
+                                     const ws2812_correction_t *corr)
+{
+    return ws2812_rmt_send(frame, WS2812_FMT_GRB, false, corr);
+}
+
+static esp_err_t ws2812_rmt_transmit_external(const uint8_t *frame, uint32_t led_count,
+                                              ws2812_pixel_fmt_t fmt,
+                                              const ws2812_correction_t *corr)
+{
+    return ws2812_rmt_send(frame, fmt, true, corr);
+}
+
+static void ws2812_rmt_deinit(void)
+{
+    ws2812_feeder_stop();
+
+    for (size_t i = 0; i < WS2812_MAX_STRIPS; i++)
+    {
+        if (s_chans[i].chan)
+        {
+            rmt_tx_wait_all_done(s_chans[i].chan, -1);
+            rmt_disable(s_chans[i].chan);
+        }
+    }
+
+    if (s_sync)
+        rmt_del_sync_manager(s_sync);
+    s_sync = NULL;
+
+    for (size_t i = 0; i < WS2812_MAX_STRIPS; i++)
+    {
+        if (s_chans[i].chan)
+            rmt_del_channel(s_chans[i].chan);
+        if (s_chans[i].encoder)
+            rmt_del_encoder(s_chans[i].encoder);
+        heap_caps_free(s_chans[i].symbols);
+    }
+    memset(s_chans, 0, sizeof(s_chans));
+
+    for (size_t c = 0; c < WS2812_CHIP_COUNT; c++)
+    {
+        heap_caps_free(s_luts[c]);
+        s_luts[c] = NULL;
+    }
+
+    heap_caps_free(s_tx_buf);
+    s_tx_buf = NULL;
+    s_tx_buf_psram = false;
+    s_strips = NULL;
+    s_strip_count = 0;
+}
+
+static uint32_t ws2812_rmt_frame_us(void)
+{
+    // Strips start together, so the slowest one sets the frame time
+    uint32_t frame_us = 0;
+    for (size_t i = 0; i < s_strip_count; i++)
+    {
+        uint32_t us = ws2812_chip_frame_us(s_strips[i].chip, s_strips[i].led_count);
+        if (us > frame_us)
+            frame_us = us;
+    }
+
+    return frame_us;
+}
+
+static esp_err_t ws2812_rmt_get_isr_stats(size_t strip_index, ws2812_isr_stats_t *out)
+{
+    if (strip_index >= s_strip_count)
+        return ESP_ERR_INVALID_ARG;
+
+    *out = s_chans[strip_index].stats;
+    return ESP_OK;
+}
+
+static const ws2812_backend_t s_rmt_backend = {
+    .name = "rmt",
+    .transmit = ws2812_rmt_transmit,
+    .transmit_external = ws2812_rmt_transmit_external,
+    .wait_done = ws2812_rmt_wait_done,
+    .deinit = ws2812_rmt_deinit,
+    .frame_us = ws2812_rmt_frame_us,
+    .get_isr_stats = ws2812_rmt_get_isr_stats,
+};
+
+esp_err_t ws2812_rmt_init(const struct ws2812_strip *strips, size_t strip_count,
+                          const ws2812_encoder_mode_t *modes,
+                          const ws2812_backend_t **out_backend)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t wire_bytes = 0;
+    size_t longest = 0;
+
+    s_strips = strips;
+    s_strip_count = strip_count;
+
+    for (size_t i = 0; i < strip_count; i++)
+    {
+        s_chans[i].mode = modes[i];
+        s_chans[i].chip = ws2812_chip_profile(strips[i].chip);
+        s_chans[i].wire_offset = wire_bytes;
+
+        uint32_t bytes = strips[i].led_count * s_chans[i].chip->bytes_per_led;
+        wire_bytes += bytes;
+        if (bytes > strips[longest].led_count * s_chans[longest].chip->bytes_per_led)
+            longest = i;
+    }
+
+    s_tx_buf = ws2812_frame_calloc(wire_bytes, 1);
+    ESP_GOTO_ON_FALSE(s_tx_buf, ESP_ERR_NO_MEM, err, TAG, "No memory for front buffer");
+    s_tx_buf_psram = esp_ptr_external_ram(s_tx_buf);
+
+    // The longest strip gets the DMA channel; it has the most refills
+    ws2812_rmt_plan_blocks(strips, strip_count, longest);
+
+    for (size_t i = 0; i < strip_count; i++)
+    {
+        ESP_GOTO_ON_ERROR(ws2812_chan_setup(&strips[i], &s_chans[i], i == longest),
+                          err, TAG, "Strip %u setup failed", (unsigned)i);
+    }
+
+    s_feeder_stopped = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(s_feeder_stopped, ESP_ERR_NO_MEM, err, TAG, "No memory for semaphore");
+    s_feeder_running = true;
+    ESP_GOTO_ON_FALSE(xTaskCreatePinnedToCore(ws2812_feeder_task, "ws2812_feed", FEEDER_STACK_SIZE,
+                                              NULL, FEEDER_PRIORITY, &s_feeder,
+                                              xPortGetCoreID()) == pdPASS,
+                      ESP_ERR_NO_MEM, err, TAG, "Cannot create feeder task");
+
+    // Hold every channel until all have been handed their frame, so all
+    // strips start on the same tick
+    if (strip_count > 1)
+    {
+        rmt_channel_handle_t chans[WS2812_MAX_STRIPS];
+        for (size_t i = 0; i < strip_count; i++)
+            chans[i] = s_chans[i].chan;
+
+        rmt_sync_manager_config_t sync_cfg = {
+            .tx_channel_array = chans,
+            .array_size = strip_count,
+        };
+        ESP_GOTO_ON_ERROR(rmt_new_sync_manager(&sync_cfg, &s_sync), err, TAG, "Cannot create sync manager");
+    }
+
+    for (size_t i = 0; i < strip_count; i++)
+    {
+        ESP_GOTO_ON_ERROR(rmt_enable(s_chans[i].chan), err, TAG, "Cannot enable RMT");
+
+        ESP_LOGI(TAG, "strip %u: gpio=%d leds=%lu chip=%s encoder=%s blocks=%u%s%s", (unsigned)i,
+                 strips[i].gpio, (unsigned long)strips[i].led_count, s_chans[i].chip->name,
+                 s_chans[i].mode == WS2812_ENCODER_LUT ? "lut" : "bytes",
+                 (unsigned)s_chans[i].mem_blocks,
+                 i == longest ? " (dma)" : "",
+                 s_tx_buf_psram && s_chans[i].mode == WS2812_ENCODER_BYTES ? " (psram)" : "");
+    }
+
+    *out_backend = &s_rmt_backend;
+    return ESP_OK;
+
+err:
+    ws2812_rmt_deinit();
+    return ret;
+}
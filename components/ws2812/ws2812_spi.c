@@ -0,0 +1,198 @@
+#include "ws2812_priv.h"
+
+#include <string.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+
+#include "driver/spi_master.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "ws2812_spi";
+
+// APA102 / SK9822 frame:
+//   start: 32 zero bits
+//   LED:   0b111 + 5-bit current, then B, G, R
+//   end:   32 zero bits (SK9822 latch) + one clock edge per two LEDs, so the
+//          data shifted along the chain reaches the last LED
+#define SPI_START_BYTES 4
+#define SPI_LED_BYTES   4
+#define SPI_LED_HEADER  0xE0
+
+static inline size_t ws2812_spi_end_bytes(uint32_t led_count)
+{
+    return 4 + (led_count + 15) / 16;
+}
+
+static const struct ws2812_strip *s_strip = NULL;
+static spi_host_device_t s_host;
+static bool s_bus_ready = false;
+static spi_device_handle_t s_dev = NULL;
+static uint32_t s_clock_hz = 0;
+static uint8_t s_header = SPI_LED_HEADER | 31;
+
+// Front buffer (DMA capable): start frame, LEDs, end frame. Only the LED
+// part is rewritten on latch.
+static uint8_t *s_dma_buf = NULL;
+static size_t s_dma_size = 0;
+
+static spi_transaction_t s_trans;
+static bool s_in_flight = false;
+
+// The SPI master ISR runs from IRAM by default, so this has to as well
+static void IRAM_ATTR ws2812_spi_post_cb(spi_transaction_t *trans)
+{
+    if (ws2812_frame_done_from_isr())
+        portYIELD_FROM_ISR();
+}
+
+static esp_err_t ws2812_spi_wait_done(int timeout_ms)
+{
+    if (!s_in_flight)
+        return ESP_OK;
+
+    TickType_t ticks = (timeout_ms < 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    spi_transaction_t *done = NULL;
+
+    ESP_RETURN_ON_ERROR(spi_device_get_trans_result(s_dev, &done, ticks), TAG, "Frame not done");
+
+    s_in_flight = false;
+    return ESP_OK;
+}
+
+// GRB frame -> header + BGR per LED, through the correction tables
+static void ws2812_spi_latch(uint8_t *dst, const uint8_t *src, uint32_t led_count,
+                             const ws2812_correction_t *corr)
+{
+    const uint8_t header = s_header;
+
+    if (corr->identity)
+    {
+        for (uint32_t i = 0; i < led_count; i++, src += 3, dst += SPI_LED_BYTES)
+        {
+            dst[0] = header;
+            dst[1] = src[2];
+            dst[2] = src[0];
+            dst[3] = src[1];
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < led_count; i++, src += 3, dst += SPI_LED_BYTES)
+    {
+        dst[0] = header;
+        dst[1] = corr->lut[2][src[2]];
+        dst[2] = corr->lut[0][src[0]];
+        dst[3] = corr->lut[1][src[1]];
+    }
+}
+
+static esp_err_t ws2812_spi_transmit(const uint8_t *frame, uint32_t led_count,
+                                     const ws2812_correction_t *corr)
+{
+    ESP_RETURN_ON_ERROR(
+        ws2812_spi_wait_done(-1),
+        TAG, "Wait for previous frame failed"
+    );
+
+    ws2812_spi_latch(s_dma_buf + SPI_START_BYTES, frame, s_strip->led_count, corr);
+
+    memset(&s_trans, 0, sizeof(s_trans));
+    s_trans.length = s_dma_size * 8;
+    s_trans.tx_buffer = s_dma_buf;
+
+    ESP_RETURN_ON_ERROR(
+        spi_device_queue_trans(s_dev, &s_trans, portMAX_DELAY),
+        TAG, "Transmit error"
+    );
+
+    s_in_flight = true;
+    return ESP_OK;
+}
+
+static uint32_t ws2812_spi_frame_us(void)
+{
+    return (uint32_t)((uint64_t)s_dma_size * 8 * 1000000 / s_clock_hz) + 1;
+}
+
+static void ws2812_spi_deinit(void)
+{
+    if (s_dev)
+    {
+        ws2812_spi_wait_done(-1);
+        spi_bus_remove_device(s_dev);
+    }
+    if (s_bus_ready)
+        spi_bus_free(s_host);
+
+    heap_caps_free(s_dma_buf);
+
+    s_dev = NULL;
+    s_bus_ready = false;
+    s_dma_buf = NULL;
+    s_dma_size = 0;
+    s_in_flight = false;
+    s_strip = NULL;
+}
+
+static const ws2812_backend_t s_spi_backend = {
+    .name = "spi",
+    .transmit = ws2812_spi_transmit,
+    .wait_done = ws2812_spi_wait_done,
+    .deinit = ws2812_spi_deinit,
+    .frame_us = ws2812_spi_frame_us,
+};
+
+esp_err_t ws2812_spi_init(const struct ws2812_strip *strip, const ws2812_spi_config_t *cfg,
+                          const ws2812_backend_t **out_backend)
+{
+    esp_err_t ret = ESP_OK;
+
+    s_strip = strip;
+    s_host = cfg->spi_host ? (spi_host_device_t)cfg->spi_host : SPI2_HOST;
+    s_clock_hz = cfg->clock_hz ? cfg->clock_hz : WS2812_SPI_CLOCK_HZ_DEFAULT;
+    s_header = SPI_LED_HEADER | ((cfg->current && cfg->current < 31) ? cfg->current : 31);
+
+    s_dma_size = SPI_START_BYTES + strip->led_count * SPI_LED_BYTES +
+                 ws2812_spi_end_bytes(strip->led_count);
+
+    // Start and end frames are zero and never rewritten
+    s_dma_buf = heap_caps_calloc(1, s_dma_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    ESP_GOTO_ON_FALSE(s_dma_buf, ESP_ERR_NO_MEM, err, TAG, "No memory for %u byte DMA buffer", (unsigned)s_dma_size);
+
+    spi_bus_config_t bus_cfg = {
+        .mosi_io_num = cfg->data_gpio,
+        .miso_io_num = -1,
+        .sclk_io_num = cfg->clock_gpio,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = s_dma_size,
+        .flags = SPICOMMON_BUSFLAG_MASTER,
+    };
+    ESP_GOTO_ON_ERROR(spi_bus_initialize(s_host, &bus_cfg, SPI_DMA_CH_AUTO), err, TAG, "Cannot init SPI bus");
+    s_bus_ready = true;
+
+    // Mode 0: the LEDs sample on the rising clock edge
+    spi_device_interface_config_t dev_cfg = {
+        .mode = 0,
+        .clock_speed_hz = s_clock_hz,
+        .spics_io_num = -1,
+        .queue_size = 1,
+        .post_cb = ws2812_spi_post_cb,
+    };
+    ESP_GOTO_ON_ERROR(spi_bus_add_device(s_host, &dev_cfg, &s_dev), err, TAG, "Cannot add SPI device");
+
+    ESP_LOGI(TAG, "SPI strip: data=%d clock=%d leds=%lu %lu Hz, %u byte frame",
+             cfg->data_gpio, cfg->clock_gpio, (unsigned long)strip->led_count,
+             (unsigned long)s_clock_hz, (unsigned)s_dma_size);
+
+    *out_backend = &s_spi_backend;
+    return ESP_OK;
+
+err:
+    ws2812_spi_deinit();
+    return ret;
+}
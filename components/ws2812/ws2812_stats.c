@@ -0,0 +1,182 @@
+#include "ws2812_priv.h"
+#include "ws2812_port.h"
+
+#include <string.h>
+
+// Show latency histogram: log-linear buckets, 8 per power of two, so any
+// percentile read from it is at most 12.5% high. Values below 8 us get a
+// bucket each; everything from 2^24 us (~17 s) up lands in the last one.
+#define STATS_SUB_BITS 3
+#define STATS_SUB      (1u << STATS_SUB_BITS)
+#define STATS_MAX_MSB  23
+#define STATS_BUCKETS  ((STATS_MAX_MSB - STATS_SUB_BITS + 2) * STATS_SUB)
+
+static bool s_on = false;
+static int64_t s_start_us = 0;
+
+static uint32_t s_frames = 0;
+static uint32_t s_show_min_us = 0;
+static uint32_t s_show_max_us = 0;
+static uint64_t s_show_sum_us = 0;
+static uint32_t s_wait_max_us = 0;
+static uint64_t s_wait_sum_us = 0;
+static uint32_t s_latch_max_us = 0;
+static uint64_t s_latch_sum_us = 0;
+static uint32_t s_queue_full = 0;
+static uint32_t s_tx_errors = 0;
+static uint64_t s_wire_bytes = 0;
+static int64_t s_last_show_us = 0;
+static volatile int64_t s_last_done_us = 0;
+static uint32_t s_hist[STATS_BUCKETS];
+
+static inline uint32_t ws2812_stats_bucket(uint32_t us)
+{
+    if (us < STATS_SUB)
+        return us;
+
+    uint32_t msb = 31 - __builtin_clz(us);
+    if (msb > STATS_MAX_MSB)
+        return STATS_BUCKETS - 1;
+
+    uint32_t sub = (us >> (msb - STATS_SUB_BITS)) & (STATS_SUB - 1);
+    return (msb - STATS_SUB_BITS + 1) * STATS_SUB + sub;
+}
+
+// Largest value that falls in bucket `b`
+static inline uint32_t ws2812_stats_bucket_top(uint32_t b)
+{
+    if (b < STATS_SUB)
+        return b;
+
+    uint32_t msb = b / STATS_SUB + STATS_SUB_BITS - 1;
+    uint32_t sub = b % STATS_SUB;
+    uint32_t step = 1u << (msb - STATS_SUB_BITS);
+
+    return ((STATS_SUB + sub) << (msb - STATS_SUB_BITS)) + step - 1;
+}
+
+bool ws2812_stats_enabled(void)
+{
+    return s_on;
+}
+
+void ws2812_stats_record(int64_t show_start_us, int64_t latch_start_us, int64_t end_us,
+                         bool was_busy, uint32_t wire_bytes, esp_err_t err)
+{
+    if (err != ESP_OK)
+    {
+        s_tx_errors++;
+        return;
+    }
+
+    uint32_t show_us = (uint32_t)(end_us - show_start_us);
+    uint32_t latch_us = (uint32_t)(end_us - latch_start_us);
+    uint32_t wait_us = show_us - latch_us;
+
+    if (s_frames == 0 || show_us < s_show_min_us)
+        s_show_min_us = show_us;
+    if (show_us > s_show_max_us)
+        s_show_max_us = show_us;
+    if (wait_us > s_wait_max_us)
+        s_wait_max_us = wait_us;
+    if (latch_us > s_latch_max_us)
+        s_latch_max_us = latch_us;
+
+    s_show_sum_us += show_us;
+    s_wait_sum_us += wait_us;
+    s_latch_sum_us += latch_us;
+    s_hist[ws2812_stats_bucket(show_us)]++;
+
+    if (was_busy)
+        s_queue_full++;
+
+    s_wire_bytes += wire_bytes;
+    s_last_show_us = latch_start_us;
+    s_frames++;
+}
+
+void IRAM_ATTR ws2812_stats_frame_done(void)
+{
+    if (s_on)
+        s_last_done_us = esp_timer_get_time();
+}
+
+void ws2812_reset_stats(void)
+{
+    s_frames = 0;
+    s_show_min_us = 0;
+    s_show_max_us = 0;
+    s_show_sum_us = 0;
+    s_wait_max_us = 0;
+    s_wait_sum_us = 0;
+    s_latch_max_us = 0;
+    s_latch_sum_us = 0;
+    s_queue_full = 0;
+    s_tx_errors = 0;
+    s_wire_bytes = 0;
+    s_last_show_us = 0;
+    s_last_done_us = 0;
+    memset(s_hist, 0, sizeof(s_hist));
+
+    s_start_us = esp_timer_get_time();
+}
+
+void ws2812_enable_stats(bool enable)
+{
+    if (enable && !s_on)
+        ws2812_reset_stats();
+
+    s_on = enable;
+}
+
+esp_err_t ws2812_get_stats(ws2812_stats_t *out)
+{
+    if (!out)
+        return ESP_ERR_INVALID_ARG;
+
+    if (!s_on)
+        return ESP_ERR_INVALID_STATE;
+
+    memset(out, 0, sizeof(*out));
+
+    uint32_t frames = s_frames;
+    out->frames = frames;
+    out->queue_full = s_queue_full;
+    out->tx_errors = s_tx_errors;
+    out->last_show_us = s_last_show_us;
+    out->last_done_us = s_last_done_us;
+
+    int64_t elapsed_us = esp_timer_get_time() - s_start_us;
+    if (elapsed_us > 0)
+        out->bytes_per_s = (uint32_t)(s_wire_bytes * 1000000 / elapsed_us);
+
+    if (frames == 0)
+        return ESP_OK;
+
+    out->show_min_us = s_show_min_us;
+    out->show_avg_us = (uint32_t)(s_show_sum_us / frames);
+    out->show_max_us = s_show_max_us;
+    out->wait_avg_us = (uint32_t)(s_wait_sum_us / frames);
+    out->wait_max_us = s_wait_max_us;
+    out->latch_avg_us = (uint32_t)(s_latch_sum_us / frames);
+    out->latch_max_us = s_latch_max_us;
+
+    // First bucket where at least 99% of frames are at or below
+    uint32_t target = frames - frames / 100;
+    uint32_t seen = 0;
+    for (uint32_t b = 0; b < STATS_BUCKETS; b++)
+    {
+        seen += s_hist[b];
+        if (seen >= target)
+        {
+            out->show_p99_us = ws2812_stats_bucket_top(b);
+            break;
+        }
+    }
+
+    // The top bucket is open-ended; never report past the real maximum
+    if (out->show_p99_us > out->show_max_us)
+        out->show_p99_us = out->show_max_us;
+
+    return ESP_OK;
+}
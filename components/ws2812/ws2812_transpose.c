@@ -0,0 +1,132 @@
+#include "ws2812_transpose.h"
+
+#include <string.h>
+
+// Both the ESP32-S3 and the build hosts are little-endian; the SWAR loads
+// below rely on byte 0 landing in the low bits of the word.
+
+static inline uint32_t load32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Transpose the 8x8 bit matrix held in (hi, lo), one row per byte with
+// row 0 in the low byte of lo. Afterwards byte b of the result (counting
+// from the top byte of hi) holds bit (7 - b) of every row, row r in bit r.
+static inline void transpose8(uint32_t *hi, uint32_t *lo)
+{
+    uint32_t x = *hi, y = *lo, t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;  y = y ^ t ^ (t << 7);
+
+    t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+
+    *hi = t;
+    *lo = y;
+}
+
+void ws2812_transpose16(const uint8_t in[16], uint16_t out[8])
+{
+    uint32_t a_lo = load32(in), a_hi = load32(in + 4);
+    uint32_t b_lo = load32(in + 8), b_hi = load32(in + 12);
+
+    transpose8(&a_hi, &a_lo);
+    transpose8(&b_hi, &b_lo);
+
+    for (int i = 0; i < 4; i++)
+    {
+        int shift = 24 - 8 * i;
+        out[i]     = ((a_hi >> shift) & 0xFF) | (((b_hi >> shift) & 0xFF) << 8);
+        out[i + 4] = ((a_lo >> shift) & 0xFF) | (((b_lo >> shift) & 0xFF) << 8);
+    }
+}
+
+void ws2812_transpose16_ref(const uint8_t in[16], uint16_t out[8])
+{
+    for (int b = 0; b < 8; b++)
+    {
+        uint16_t w = 0;
+        for (int l = 0; l < 16; l++)
+        {
+            if (in[l] & (0x80 >> b))
+                w |= (uint16_t)(1u << l);
+        }
+        out[b] = w;
+    }
+}
+
+size_t ws2812_transpose_encoded_size(size_t lane_count, size_t max_lane_bytes)
+{
+    size_t word_size = (lane_count <= 8) ? 1 : 2;
+    return max_lane_bytes * 8 * WS2812_TRANSPOSE_SLOTS_PER_BIT * word_size;
+}
+
+size_t ws2812_transpose_encode(const uint8_t *const lanes[], const uint32_t lane_bytes[],
+                               size_t lane_count, const uint8_t lut[3][256], void *out)
+{
+    if (lane_count == 0 || lane_count > WS2812_TRANSPOSE_MAX_LANES)
+        return 0;
+
+    uint32_t max_bytes = 0;
+    for (size_t l = 0; l < lane_count; l++)
+    {
+        if (lane_bytes[l] > max_bytes)
+            max_bytes = lane_bytes[l];
+    }
+
+    uint8_t *out8 = out;
+    uint16_t *out16 = out;
+    uint8_t in[16] = {0};
+    uint16_t bits[8];
+
+    for (uint32_t k = 0; k < max_bytes; k++)
+    {
+        // Every lane starts on a pixel, so byte k is the same color for all
+        const uint8_t *map = lut ? lut[k % 3] : NULL;
+
+        // Lanes that ran out of data stay low, including the start slot
+        uint16_t active = 0;
+        for (size_t l = 0; l < lane_count; l++)
+        {
+            if (k < lane_bytes[l])
+            {
+                in[l] = map ? map[lanes[l][k]] : lanes[l][k];
+                active |= (uint16_t)(1u << l);
+            }
+            else
+            {
+                in[l] = 0;
+            }
+        }
+
+        ws2812_transpose16(in, bits);
+
+        if (lane_count <= 8)
+        {
+            for (int b = 0; b < 8; b++)
+            {
+                *out8++ = (uint8_t)active;
+                *out8++ = (uint8_t)bits[b];
+                *out8++ = 0;
+            }
+        }
+        else
+        {
+            for (int b = 0; b < 8; b++)
+            {
+                *out16++ = active;
+                *out16++ = bits[b];
+                *out16++ = 0;
+            }
+        }
+    }
+
+    return ws2812_transpose_encoded_size(lane_count, max_bytes);
+}
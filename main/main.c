@@ -3,20 +3,62 @@
 #include "ws2812.h"
 #include "led_effects.h"
 #include "led_topology.h"
+#include "led_math.h"
 
 #include "esp_log.h"
 #include "esp_err.h"
-#include "esp_timer.h"
-
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 
 /* Forward declaration of the effect */
 void effect_breathe(
-    led_topology_t *topo,
+    rgb16_t *buf,
+    uint32_t count,
+    uint32_t offset,
     effect_time_t *time,
     void *user_ctx);
 
+/* Give every strip with its own data pin an RMT channel; daisy-chained
+   strips (gpio = -1) extend the channel of the strip before them, so the
+   first strip must have a pin of its own. All strips run the chip profile
+   named in system.json. */
+static esp_err_t init_output(const led_topology_t *topo, const char *chip_name)
+{
+    ws2812_chip_t chip = ws2812_chip_from_name(chip_name);
+    if (chip == WS2812_CHIP_COUNT)
+    {
+        ESP_LOGW("MAIN", "Unknown LED chip '%s', using ws2812b", chip_name);
+        chip = WS2812_CHIP_WS2812B;
+    }
+
+    if (topo->strip_count == 0 || topo->strips[0].gpio < 0)
+        return ESP_ERR_INVALID_ARG;
+
+    ws2812_strip_config_t out[WS2812_MAX_STRIPS];
+    size_t count = 0;
+
+    for (uint8_t i = 0; i < topo->strip_count; i++)
+    {
+        const led_strip_t *s = &topo->strips[i];
+
+        if (s->gpio >= 0)
+        {
+            if (count == WS2812_MAX_STRIPS)
+                return ESP_ERR_NOT_SUPPORTED;
+
+            out[count].gpio = (gpio_num_t)s->gpio;
+            out[count].led_count = s->led_count;
+            out[count].encoder = WS2812_ENCODER_BYTES;
+            out[count].chip = chip;
+            count++;
+        }
+        else
+        {
+            out[count - 1].led_count += s->led_count;
+        }
+    }
+
+    return ws2812_init_strips(out, count);
+}
+
 void app_main(void)
 {
     esp_err_t err;
@@ -44,57 +86,85 @@ void app_main(void)
              cfg->device_name,
              cfg->ble_name);
 
-    /* --- WS2812 init --- */
-    err = ws2812_init((gpio_num_t)cfg->led_gpio, cfg->led_count);
+    /* --- Stage 5: Topology Engine (RUNTIME init, not const) ---
+       Static: the render task keeps using it after app_main returns */
+    static led_strip_t strips[1];
+    strips[0].led_count = cfg->led_count;
+    strips[0].reversed = false;
+    strips[0].gpio = cfg->led_gpio;
+
+    static led_topology_t topology;
+    topology.strip_count = 1;
+    topology.strips = strips;
+
+    err = led_topology_init(&topology);
     if (err != ESP_OK)
     {
-        ESP_LOGE("MAIN", "WS2812 init FAILED: %s", esp_err_to_name(err));
+        ESP_LOGE("MAIN", "Topology init FAILED: %s", esp_err_to_name(err));
         return;
     }
 
-    /* --- Stage 5: Topology Engine (RUNTIME init, not const) --- */
-    led_strip_t strips[1];
-    strips[0].led_count = cfg->led_count;
-    strips[0].reversed = false;
+    /* --- WS2812 init: one RMT channel per wired strip --- */
+    err = init_output(&topology, cfg->led_chip);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE("MAIN", "WS2812 init FAILED: %s", esp_err_to_name(err));
+        return;
+    }
 
-    led_topology_t topology;
-    topology.strip_count = 1;
-    topology.strips = strips;
+    /* 16-bit pipeline: smooth low-level fades via temporal dithering */
+    err = ws2812_enable_16bit(true);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW("MAIN", "16-bit output unavailable: %s", esp_err_to_name(err));
+    }
 
-    led_topology_init(&topology);
+    /* Keep the LEDs within what the bike's supply can deliver */
+    if (cfg->power_budget_ma > 0)
+    {
+        err = ws2812_set_power_limit(cfg->power_budget_ma, NULL);
+        if (err != ESP_OK)
+            ESP_LOGW("MAIN", "LED current limit unavailable: %s", esp_err_to_name(err));
+        else
+            ESP_LOGI("MAIN", "LED current limit: %lu mA", (unsigned long)cfg->power_budget_ma);
+    }
 
     /* --- Stage 6: Effects Engine --- */
     led_effects_init(&topology);
 
     static struct
     {
-        float phase;
-        float speed;
+        uint16_t phase;
+        uint16_t phase_rem;
+        q8_8_t speed;
         uint8_t r, g, b;
     } breathe_ctx = {
-        .phase = 0.0f,
-        .speed = 0.5f,
+        .phase = 0,
+        .phase_rem = 0,
+        .speed = Q8_8(0.5f),
         .r = 0,
         .g = 0,
         .b = 255};
 
     static const led_effect_t breathe_effect = {
         .name = "breathe_blue",
-        .render = effect_breathe,
+        .render16 = effect_breathe,
         .user_ctx = &breathe_ctx};
 
     led_effects_set(&breathe_effect);
 
-    /* --- Main loop --- */
-    while (true)
-    {
-        uint32_t now_ms = esp_timer_get_time() / 1000;
-
-        led_effects_tick(now_ms);
+    /* --- Render task on core 1, paced by its own frame clock --- */
+    led_effects_task_config_t render_cfg = LED_EFFECTS_TASK_CONFIG_DEFAULT();
+    if (cfg->render_fps >= 1 && cfg->render_fps <= 1000)
+        render_cfg.fps = cfg->render_fps;
+    else
+        ESP_LOGW("MAIN", "Invalid render_fps %lu, using %lu", (unsigned long)cfg->render_fps,
+                 (unsigned long)render_cfg.fps);
 
-        /* Use the REAL ws2812 API */
-        ws2812_show();
-
-        vTaskDelay(pdMS_TO_TICKS(10)); // ~100 FPS
+    err = led_effects_start(&render_cfg);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE("MAIN", "Render task start FAILED: %s", esp_err_to_name(err));
+        return;
     }
 }